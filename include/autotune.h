@@ -0,0 +1,33 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Monta a chave que identifica a máquina atual no arquivo de perfis,
+ * composta pelo modelo da CPU e pelos tamanhos das caches L1d, L2 e L3.
+ * @param chave O buffer onde a chave será escrita.
+ * @param tamanho O tamanho de `chave` em bytes.
+ */
+void identificar_maquina(char* chave, size_t tamanho);
+
+//< Retorna o caminho padrão do arquivo de perfis (`$XDG_CACHE_HOME` ou `~/.cache`).
+const char* caminho_perfil_padrao(void);
+
+/**
+ * @brief Procura a máquina atual no arquivo de perfis e, se encontrada,
+ * aplica sua configuração de blocos com `definir_config_blocos`.
+ * @returns `1` se um perfil foi aplicado, ou `0` caso contrário.
+ */
+int carregar_perfil(const char* caminho);
+
+/**
+ * @brief Mede o produto de matrizes em formatos representativos variando
+ * os tamanhos de bloco e o desenrolamento, aplica a melhor configuração e a
+ * salva em `caminho`, substituindo o perfil anterior desta máquina. Caso
+ * alguma medição falhe (e.g. `token_operacao()` parou), nada é salvo.
+ * @returns `1` em caso de sucesso, ou `0` se o perfil não pôde ser salvo.
+ */
+int ajustar_blocos(const char* caminho);
+
+#endif // AUTOTUNE_H
@@ -0,0 +1,68 @@
+#ifndef CANCELAMENTO_H
+#define CANCELAMENTO_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * @brief Um token de parada cooperativa. Os kernels consultam o token entre
+ * blocos de trabalho (`token_parado`) e retornam mais cedo quando ele é
+ * cancelado, quando o seu prazo passa ou quando algum token pai para. As
+ * threads nunca são interrompidas de fora: quem as criou sempre as aguarda
+ * com `pthread_join`, mesmo em caso de erro.
+ *
+ * O sucesso de uma operação não é decidido consultando `token_parado` após
+ * o trabalho (o prazo pode passar logo após o último bloco), e sim por
+ * `token_incompleto`, marcado apenas por quem de fato deixou trabalho por fazer.
+ */
+typedef struct TokenParada {
+    //< Indica se o token foi cancelado ou se seu prazo já passou.
+    _Atomic bool parado;
+
+    //< O instante (s, em `CLOCK_MONOTONIC`) após o qual o token para, ou `0`.
+    double prazo;
+
+    //< Um token cuja parada também para este (ou `NULL`).
+    struct TokenParada* pai;
+
+    //< Indica que algum trabalho controlado por este token não foi
+    // concluído, por ter parado mais cedo ou por ter falhado.
+    _Atomic bool incompleto;
+} TokenParada;
+
+/**
+ * @brief Inicializa um token.
+ * @param pai Um token cuja parada também para este (ou `NULL`).
+ * @param segundos O prazo a partir de agora, ou `0` para não ter prazo.
+ */
+void token_iniciar(TokenParada* token, TokenParada* pai, double segundos);
+
+//< Cancela o token. Pode ser chamada de qualquer thread ou de um tratador de sinal.
+void token_cancelar(TokenParada* token);
+
+//< Retorna `true` se o token (ou algum pai) foi cancelado ou teve o prazo excedido.
+bool token_parado(TokenParada* token);
+
+//< Marca que algum trabalho controlado pelo token não foi concluído.
+void token_marcar_incompleto(TokenParada* token);
+
+//< Retorna `true` se algum trabalho controlado pelo token não foi concluído.
+bool token_incompleto(const TokenParada* token);
+
+//< Retorna os segundos até o prazo mais próximo do token e seus pais, ou `-1` se não houver prazo.
+double token_restante(const TokenParada* token);
+
+/**
+ * @brief Retorna o token da operação em andamento, consultado por todos os
+ * produtos (sequenciais, paralelos e entre processos). Processos criados
+ * com `fork` herdam uma cópia, incluindo o prazo.
+ */
+TokenParada* token_operacao(void);
+
+//< Define o prazo da operação que está para começar (`0` para não ter prazo).
+void definir_prazo_operacao(double segundos);
+
+//< Faz com que `SIGINT` cancele a operação em andamento; um segundo `SIGINT` encerra o programa.
+void instalar_cancelamento_sinal(void);
+
+#endif // CANCELAMENTO_H
@@ -0,0 +1,157 @@
+#ifndef FRAME_METRICS_H
+#define FRAME_METRICS_H
+
+#include "utils.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Métricas por quadro da simulação, exportadas em uma memória compartilhada
+ * POSIX para que um processo externo (`sim-monitor`) as leia enquanto a
+ * simulação executa. O único escritor é o laço principal da simulação, que
+ * nunca bloqueia: os histogramas são atualizados com operações atômicas
+ * relaxadas e o anel sobrescreve os registros mais antigos. Cada entrada
+ * do anel é protegida por um seqlock, para que o leitor descarte os
+ * registros sobrescritos antes ou durante a cópia.
+ */
+
+//< Define a quantidade de sub-baldes dos histogramas (erro relativo de 3% a 6%).
+#define HISTOGRAMA_BITS_SUB 5
+#define HISTOGRAMA_SUB (1u << HISTOGRAMA_BITS_SUB)
+
+//< Os histogramas cobrem valores em `[0, 2^HISTOGRAMA_EXPOENTES)` ns.
+#define HISTOGRAMA_EXPOENTES 40
+
+//< Quantidade de baldes de cada histograma.
+#define HISTOGRAMA_BALDES (HISTOGRAMA_SUB + (HISTOGRAMA_EXPOENTES - HISTOGRAMA_BITS_SUB) * (HISTOGRAMA_SUB / 2))
+
+//< Quantidade máxima de threads de renderização com tempos próprios.
+#define MAX_THREADS_METRICAS 32
+
+//< Quantidade de registros do anel de quadros.
+#define CAPACIDADE_ANEL_METRICAS 16384
+
+//< As fases medidas em cada quadro.
+typedef enum {
+    //< Movimento e colisões dos círculos.
+    FASE_FISICA,
+    //< Renderização completa, vista pela thread principal.
+    FASE_RENDER,
+    //< Tempo médio que as threads de renderização passam ociosas na fase de renderização.
+    FASE_ESPERA,
+    //< Hash do primeiro quadro e cópia do quadro para o gravador.
+    FASE_GRAVACAO,
+    //< Cópia do quadro para a superfície da janela.
+    FASE_BLIT,
+    //< Envio do quadro para a tela.
+    FASE_APRESENTAR,
+    //< O quadro inteiro.
+    FASE_QUADRO,
+    FASES_QUADRO,
+} fase_quadro_t;
+
+/**
+ * @brief Um histograma log-linear (à la HdrHistogram) de latências em ns.
+ * Valores menores que `HISTOGRAMA_SUB` têm baldes exatos; cada potência de
+ * 2 acima disso é dividida em `HISTOGRAMA_SUB / 2` baldes de mesma largura.
+ */
+typedef struct {
+    _Atomic uint64_t baldes[HISTOGRAMA_BALDES];
+    _Atomic uint64_t total;
+    _Atomic uint64_t maximo;
+} HistogramaLatencia;
+
+//< Os tempos (ns) de um quadro.
+typedef struct {
+    uint64_t quadro;
+    uint32_t fases[FASES_QUADRO];
+    uint32_t reservado; //< Completa a última palavra de 64 bits.
+    uint32_t render[MAX_THREADS_METRICAS];
+} RegistroQuadro;
+
+//< Quantidade de palavras de 64 bits de um `RegistroQuadro`.
+#define PALAVRAS_REGISTRO (sizeof(RegistroQuadro) / sizeof(uint64_t))
+_Static_assert(sizeof(RegistroQuadro) % sizeof(uint64_t) == 0, "RegistroQuadro deve ocupar palavras inteiras");
+
+/**
+ * @brief Uma entrada do anel, protegida por um seqlock. `sequencia` é ímpar
+ * enquanto o escritor copia o registro e, ao terminar de escrever o registro
+ * `i`, vale `2 * (i / CAPACIDADE_ANEL_METRICAS + 1)`. As palavras são
+ * acessadas com operações atômicas relaxadas, então uma cópia concorrente
+ * com a escrita é detectada pela sequência, e nunca é uma corrida de dados.
+ */
+typedef struct {
+    _Atomic uint64_t sequencia;
+    _Atomic uint64_t palavras[PALAVRAS_REGISTRO];
+} EntradaAnelMetricas;
+
+//< O conteúdo da memória compartilhada das métricas.
+typedef struct {
+    //< Identificam o formato da memória, verificados pelo leitor.
+    uint32_t magica;
+    uint32_t versao;
+
+    //< A quantidade de threads de renderização com tempos em `render`.
+    uint32_t threads;
+
+    //< Indica se a simulação ainda está executando.
+    _Atomic uint32_t ativo;
+
+    //< Quantidade de registros já escritos no anel. O registro `i` fica em
+    // `anel[i % CAPACIDADE_ANEL_METRICAS]`, até ser sobrescrito.
+    ALINHADO_CACHE _Atomic uint64_t escritos;
+
+    //< Histogramas acumulados desde o início da simulação.
+    ALINHADO_CACHE HistogramaLatencia fases[FASES_QUADRO];
+    HistogramaLatencia render[MAX_THREADS_METRICAS];
+
+    //< Os registros dos quadros mais recentes.
+    EntradaAnelMetricas anel[CAPACIDADE_ANEL_METRICAS];
+} MetricasCompartilhadas;
+
+//< O lado escritor das métricas, mantido pela simulação.
+typedef struct MetricasQuadro MetricasQuadro;
+
+//< Retorna um instante de um relógio monotônico em ns.
+uint64_t agora_ns(void);
+
+//< Retorna o nome de uma fase, para a saída.
+const char* nome_fase(fase_quadro_t fase);
+
+//< Registra um valor (ns) no histograma. Apenas uma thread pode registrar em cada histograma.
+void histograma_registrar(HistogramaLatencia* h, uint64_t valor);
+
+//< Retorna o maior valor (ns) equivalente ao percentil `p` (em `[0, 1]`) do histograma.
+uint64_t histograma_percentil(const HistogramaLatencia* h, double p);
+
+/**
+ * @brief Cria a memória compartilhada `nome` (prefixado com `/` se
+ * necessário) para as métricas de uma simulação com `threads` threads de
+ * renderização.
+ * @returns As métricas criadas, ou `NULL` em caso de falha.
+ */
+MetricasQuadro* metricas_criar(const char* nome, int threads);
+
+//< Registra os tempos de um quadro nos histogramas e no anel, sem bloquear.
+void metricas_registrar(MetricasQuadro* m, const RegistroQuadro* registro);
+
+//< Marca a simulação como encerrada e remove a memória compartilhada.
+void metricas_destruir(MetricasQuadro* m);
+
+//< Mapeia, somente para leitura, as métricas publicadas em `nome`, ou retorna `NULL`.
+const MetricasCompartilhadas* metricas_abrir(const char* nome);
+
+//< Desmapeia as métricas abertas com `metricas_abrir`.
+void metricas_fechar(const MetricasCompartilhadas* m);
+
+/**
+ * @brief Copia até `max` registros do anel, a partir do registro
+ * `*proximo`, e avança `*proximo`. Registros sobrescritos antes ou durante
+ * a cópia são ignorados e contados em `*perdidos`.
+ * @returns A quantidade de registros copiados para `destino`.
+ */
+size_t metricas_ler(const MetricasCompartilhadas* m, uint64_t* proximo, RegistroQuadro* destino, size_t max,
+    uint64_t* perdidos);
+
+#endif // FRAME_METRICS_H
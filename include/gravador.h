@@ -0,0 +1,71 @@
+#ifndef GRAVADOR_H
+#define GRAVADOR_H
+
+#include <stddef.h>
+
+/**
+ * @brief Formatos de arquivo suportados pelo gravador de quadros.
+ *
+ * - `GRAVACAO_RAW`: quadros RGBA8888 concatenados, sem cabeçalho (no
+ *   `ffmpeg`, `-f rawvideo -pix_fmt abgr -s LxA` em máquinas little-endian);
+ * - `GRAVACAO_Y4M`: YUV4MPEG2 com amostragem 4:4:4;
+ * - `GRAVACAO_DELTA`: cada quadro é o XOR com o quadro anterior, comprimido
+ *   em sequências (RLE) de píxeis inalterados e literais.
+ */
+typedef enum {
+    GRAVACAO_RAW,
+    GRAVACAO_Y4M,
+    GRAVACAO_DELTA,
+} formato_gravacao_t;
+
+//< Contadores de quadros acumulados durante uma gravação.
+typedef struct {
+    //< Quadros entregues ao gravador pelo renderizador.
+    size_t enviados;
+
+    //< Quadros efetivamente escritos em disco.
+    size_t gravados;
+
+    //< Quadros perdidos porque o anel estava cheio (modo de descarte).
+    size_t descartados;
+
+    //< Quadros que bloquearam o renderizador até liberar espaço no anel.
+    size_t bloqueados;
+
+    //< Indica se houve algum erro de escrita no arquivo.
+    int erro_escrita;
+} EstatisticasGravacao;
+
+//< Um gravador assíncrono de quadros com uma thread de escrita dedicada.
+typedef struct Gravador Gravador;
+
+//< Escolhe o formato de gravação pela extensão do arquivo (`.y4m`, `.rle` ou raw).
+formato_gravacao_t formato_por_extensao(const char* caminho);
+
+/**
+ * @brief Abre o arquivo de saída, pré-aloca o anel de quadros e inicia a
+ * thread de escrita.
+ * @param caminho O arquivo de saída; o formato é deduzido da extensão.
+ * @param largura A largura dos quadros (px).
+ * @param altura A altura dos quadros (px).
+ * @param fps A taxa de quadros nominal registrada no cabeçalho (Y4M).
+ * @param capacidade A quantidade de quadros pré-alocados no anel (>= 2).
+ * @param descartar Se não-zero, quadros são descartados quando o anel está
+ * cheio; caso contrário, o renderizador aguarda a escrita.
+ * @returns O gravador criado, ou `NULL` em caso de falha.
+ */
+Gravador* gravador_criar(const char* caminho, int largura, int altura, int fps, size_t capacidade, int descartar);
+
+/**
+ * @brief Copia um quadro finalizado para o anel. Só bloqueia caso o anel
+ * esteja cheio e o gravador não esteja em modo de descarte.
+ * @param pixels O início do quadro RGBA8888.
+ * @param pitch A quantidade de bytes entre o início de duas linhas de `pixels`.
+ * @returns `1` se o quadro foi enfileirado, `0` se foi descartado.
+ */
+int gravador_enviar(Gravador* gravador, const void* pixels, size_t pitch);
+
+//< Escreve os quadros pendentes, encerra a thread e libera o gravador.
+EstatisticasGravacao gravador_finalizar(Gravador* gravador);
+
+#endif // GRAVADOR_H
@@ -2,19 +2,66 @@
 #define MATRIX_PRODUCT_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct {
     int *dados;
     size_t linhas;
     size_t colunas;
+
+    //< A distância, em elementos, entre o início de duas linhas consecutivas
+    // (`ld >= colunas`). Cada linha começa alinhada a 64 bytes.
+    size_t ld;
+
+    //< O tamanho do mapeamento com huge pages explícitas, ou `0` caso
+    // `dados` tenha sido alocado com `posix_memalign`.
+    size_t mapeado;
 } matriz_t;
 
+/**
+ * @brief Uma visão (sem posse dos dados) de um bloco de uma matriz. Como
+ * compartilha os campos `dados` e `ld` com `matriz_t`, também pode ser
+ * acessada com `MAT_POS`.
+ */
+typedef struct {
+    int *dados;
+    size_t linhas;
+    size_t colunas;
+    size_t ld;
+} visao_matriz_t;
+
+/**
+ * @brief Os parâmetros de blocagem do kernel de produto de matrizes. Os
+ * melhores valores dependem das caches de cada máquina (ver `autotune.h`).
+ */
+typedef struct {
+    //< Quantidade de linhas de `destino` por bloco.
+    size_t bloco_i;
+
+    //< Quantidade de colunas de `destino` por bloco.
+    size_t bloco_j;
+
+    //< Quantidade de linhas de `b` percorridas por fatia.
+    size_t bloco_k;
+
+    //< Quantas linhas de `b` o laço interno consome por vez (1, 2 ou 4).
+    int desenrolar;
+} config_blocos_t;
+
+//< Quantidade máxima de elementos (`bloco_i * bloco_j`) de um bloco de
+// `destino`. Os acumuladores do bloco ficam na pilha (256 KiB), para que o
+// produto não aloque memória.
+#define MAX_ELEMENTOS_BLOCO (64 * 1024)
+
 //< Acessa a matriz `m` na linha `i` e coluna `j`.
-#define MAT_POS(m, i, j) (m->dados[(i * m->colunas) + j])
+#define MAT_POS(m, i, j) ((m)->dados[((i) * (m)->ld) + (j)])
 
-//< Cria uma matriz com uma dimensão dada.
+//< Cria uma matriz com uma dimensão dada e todos os elementos zerados.
 matriz_t *criar_matriz(size_t linhas, size_t colunas);
 
+//< Cria uma matriz sem inicializar os elementos, para quando todos serão sobrescritos.
+matriz_t *criar_matriz_sem_zerar(size_t linhas, size_t colunas);
+
 //< Gera uma matriz com uma dimensão dada e valores aleatórios.
 matriz_t *gerar_matriz(size_t linhas, size_t colunas, int min, int max);
 
@@ -24,10 +71,48 @@ void imprimir_matriz(const matriz_t *matriz, const char *nome);
 //< Libera a memória associada à uma matriz.
 void free_matriz(matriz_t* matriz);
 
+//< Calcula o hash dos elementos de uma matriz, ignorando o preenchimento das linhas.
+uint64_t checksum_matriz(const matriz_t* matriz);
+
 //< Calcula sequencialmente o produto `a * b` entre duas matrizes.
 matriz_t *produto_matrizes_seq(const matriz_t* a, const matriz_t* b);
 
 //< Calcula paralelamente o produto `a * b` entre duas matrizes, dado o número de threads.
 matriz_t *produto_matrizes_par(const matriz_t* a, const matriz_t* b, int num_threads);
 
+//< Calcula o produto `a * b` dividindo as linhas do resultado entre `num_processos` processos, com as matrizes em memória compartilhada.
+matriz_t *produto_matrizes_proc(const matriz_t* a, const matriz_t* b, int num_processos);
+
+//< Define os tamanhos de bloco usados pelos próximos produtos, retornando `0` (sem alterá-los) caso sejam inválidos.
+int definir_config_blocos(config_blocos_t config);
+
+//< Retorna os tamanhos de bloco usados atualmente.
+config_blocos_t obter_config_blocos(void);
+
+//< Cria uma visão que cobre a matriz inteira.
+visao_matriz_t visao_matriz(const matriz_t* m);
+
+//< Cria uma visão do bloco `linhas x colunas` de `v` que começa em (`lin`, `col`).
+visao_matriz_t visao_submatriz(visao_matriz_t v, size_t lin, size_t col, size_t linhas, size_t colunas);
+
+/**
+ * @brief Calcula sequencialmente `c = alfa * a * b + beta * c`, sem alocar
+ * memória (os acumuladores de cada bloco ficam na pilha). Com `beta == 0`,
+ * `c` não é lido e pode estar não inicializado. `c` não pode se sobrepor a
+ * `a` ou `b`.
+ * @returns `1` em caso de sucesso, ou `0` se as dimensões forem
+ * incompatíveis ou se `token_operacao()` parar antes do fim (deixando `c`
+ * incompleta).
+ */
+int gemm_seq(int alfa, visao_matriz_t a, visao_matriz_t b, int beta, visao_matriz_t c);
+
+/**
+ * @brief Versão paralela de `gemm_seq`, dividindo as linhas de `c` entre
+ * `num_threads` threads. Aloca apenas o estado das threads.
+ * @returns `1` em caso de sucesso, ou `0` nos casos de `gemm_seq` e caso o
+ * estado das threads não possa ser alocado ou alguma thread não possa ser
+ * criada (deixando `c` incompleta).
+ */
+int gemm_par(int alfa, visao_matriz_t a, visao_matriz_t b, int beta, visao_matriz_t c, int num_threads);
+
 #endif // MATRIX_PRODUCT_H
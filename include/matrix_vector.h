@@ -0,0 +1,28 @@
+#ifndef MATRIX_VECTOR_H
+#define MATRIX_VECTOR_H
+
+#include "matrix_product.h"
+#include <stddef.h>
+
+/**
+ * Produtos matriz-vetor com `k` vetores à direita de uma só vez, para que
+ * `a` seja lida da memória uma única vez. Os `k` vetores de `x` são
+ * armazenados em sequência, cada um com `a.colunas` elementos (`a.linhas`
+ * na versão transposta); os resultados são escritos da mesma forma em `y`,
+ * cada um com `a.linhas` elementos (`a.colunas` na versão transposta).
+ * As funções retornam `0`, com `y` incompleto, caso `token_operacao()` pare.
+ */
+
+//< Calcula sequencialmente `y_r = a * x_r` para os `k` vetores, retornando 1 em caso de sucesso.
+int gemv_seq(visao_matriz_t a, const int* x, size_t k, long long* y);
+
+//< Calcula paralelamente `y_r = a * x_r`, dividindo blocos de linhas de `a` entre as threads.
+int gemv_par(visao_matriz_t a, const int* x, size_t k, long long* y, int num_threads);
+
+//< Calcula sequencialmente `y_r = aᵀ * x_r` para os `k` vetores, retornando 1 em caso de sucesso.
+int gemv_t_seq(visao_matriz_t a, const int* x, size_t k, long long* y);
+
+//< Calcula paralelamente `y_r = aᵀ * x_r`, dividindo blocos de colunas de `a` entre as threads.
+int gemv_t_par(visao_matriz_t a, const int* x, size_t k, long long* y, int num_threads);
+
+#endif // MATRIX_VECTOR_H
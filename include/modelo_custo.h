@@ -0,0 +1,61 @@
+#ifndef MODELO_CUSTO_H
+#define MODELO_CUSTO_H
+
+#include "utils.h"
+
+/**
+ * @brief Um modelo de custo calibrado na inicialização do programa, usado
+ * para escolher entre execução sequencial e paralela e a quantidade de
+ * threads. O tempo estimado com `t` threads é
+ *
+ *     T(t) = operacoes * tempo_operacao / min(t, nucleos) + t * custo_por_thread
+ *
+ * e `T(1)` sequencial não paga o custo das threads.
+ */
+typedef struct {
+    //< Custo de criar e aguardar (`pthread_create` + `pthread_join`) uma thread (s).
+    double custo_thread;
+
+    //< Custo de acordar uma thread já criada e sincronizar com ela por uma
+    // barreira (s), como no renderizador paralelo da simulação.
+    double custo_despertar;
+
+    //< Tempo de uma operação do kernel medido sequencialmente (s).
+    double tempo_operacao;
+
+    //< A quantidade de núcleos disponíveis.
+    int nucleos;
+} ModeloCusto;
+
+//< Uma carga representativa do kernel, executada durante a calibração.
+typedef void (*carga_f)(void* dados);
+
+/**
+ * @brief Calibra o modelo medindo o custo das threads na máquina atual e a
+ * vazão do kernel ao executar `carga`.
+ * @param carga Executa uma amostra do kernel com `operacoes` operações.
+ * @param dados Os dados passados para `carga`.
+ * @param operacoes A quantidade de operações (e.g. multiplicações) de uma
+ * execução de `carga`.
+ */
+ModeloCusto calibrar_modelo(carga_f carga, void* dados, double operacoes);
+
+//< Estima o tempo de `operacoes` operações com `threads` threads (`paralelo = 0` para sequencial).
+double estimar_tempo(const ModeloCusto* modelo, double operacoes, double custo_por_thread, int threads, int paralelo);
+
+/**
+ * @brief Resolve `--mode auto` e `--threads auto` em `args` para a operação
+ * estimada, deixando `args->mode` como `SEQ` ou `PAR` (ou `PROC`, se pedido)
+ * e `args->threads >= 1`. Argumentos já definidos explicitamente são
+ * mantidos. No modo `PROC`, `custo_por_thread` é substituído pelo custo
+ * medido de criar um processo.
+ * @param operacoes A quantidade de operações da chamada.
+ * @param custo_por_thread O custo fixo de cada thread usada (`custo_thread`
+ * ou `custo_despertar`).
+ */
+void resolver_execucao(Args* args, const ModeloCusto* modelo, double operacoes, double custo_por_thread);
+
+//< Retorna se `args` pede alguma decisão automática.
+int precisa_modelo(const Args* args);
+
+#endif // MODELO_CUSTO_H
@@ -0,0 +1,75 @@
+#ifndef PROCESSOS_H
+#define PROCESSOS_H
+
+#include <stddef.h>
+
+//< Tamanho máximo do nome de uma memória compartilhada.
+#define TAMANHO_NOME_MEMORIA 64
+
+//< Tamanho máximo dos parâmetros específicos de cada operação.
+#define TAMANHO_PARAMETROS 256
+
+//< Uma região de memória compartilhada POSIX (`shm_open`), identificada por nome.
+typedef struct {
+    char nome[TAMANHO_NOME_MEMORIA];
+    void* base;
+    size_t tamanho;
+} MemoriaCompartilhada;
+
+/**
+ * @brief A tarefa enviada a um processo trabalhador pelo socket. O
+ * trabalhador mapeia a memória pelo nome, então a tarefa não depende de
+ * ponteiros do processo que a enviou.
+ */
+typedef struct {
+    //< A memória compartilhada com os operandos (e, se houver, o destino).
+    char memoria[TAMANHO_NOME_MEMORIA];
+    size_t tamanho_memoria;
+
+    //< O fragmento `[inicio, fim)` que o trabalhador deve calcular.
+    size_t inicio;
+    size_t fim;
+
+    //< Parâmetros específicos da operação (dimensões, deslocamentos, ...).
+    unsigned char parametros[TAMANHO_PARAMETROS];
+} TarefaProcesso;
+
+/**
+ * @brief Calcula um fragmento de uma operação dentro do trabalhador.
+ * @param base O início da memória compartilhada, já mapeada.
+ * @param tarefa A tarefa recebida.
+ * @param ok Deve receber `0` caso o fragmento falhe.
+ * @returns O resultado parcial do fragmento, somado pelo processo principal.
+ */
+typedef long long (*fragmento_f)(void* base, const TarefaProcesso* tarefa, int* ok);
+
+//< Cria e mapeia uma memória compartilhada com `tamanho` bytes, retornando `1` em caso de sucesso.
+int criar_memoria_compartilhada(MemoriaCompartilhada* memoria, size_t tamanho);
+
+//< Desmapeia e remove o nome de uma memória compartilhada.
+void liberar_memoria_compartilhada(MemoriaCompartilhada* memoria);
+
+/**
+ * @brief Copia `n` bytes de `origem` para `destino` (e.g. os operandos para
+ * a memória compartilhada) em blocos, consultando `token_operacao()` entre
+ * eles, e marca o token como incompleto caso a operação pare.
+ * @returns `1` se a cópia foi concluída, ou `0` caso a operação tenha parado.
+ */
+int copiar_operandos(void* destino, const void* origem, size_t n);
+
+/**
+ * @brief Divide `[0, total)` em `num_processos` fragmentos e cria um processo
+ * trabalhador para cada um (`fork`), conectado por um socket UNIX. Cada
+ * trabalhador recebe sua tarefa pelo socket, mapeia `memoria` pelo nome,
+ * executa `fragmento` e devolve o resultado parcial pelo mesmo socket.
+ * Fragmentos cujo processo não pôde ser criado são calculados localmente.
+ * Caso `token_operacao()` pare (cancelamento ou prazo), os trabalhadores
+ * que ainda não responderam são encerrados com `SIGKILL`.
+ * @param parametros Copiados para `TarefaProcesso.parametros` de cada tarefa.
+ * @param soma Recebe a soma dos resultados parciais.
+ * @returns `1` se todos os fragmentos foram calculados, ou `0` caso contrário.
+ */
+int executar_processos(const MemoriaCompartilhada* memoria, size_t total, int num_processos,
+    const void* parametros, size_t tamanho_parametros, fragmento_f fragmento, long long* soma);
+
+#endif // PROCESSOS_H
@@ -6,10 +6,19 @@
 //< Gera um vetor de tamanho `n` com números aleatórios entre `min` e `max`.
 int* gerar_vetor(size_t n, int min, int max);
 
+/**
+ * Os produtos escalares param mais cedo, com um resultado parcial, quando
+ * `token_operacao()` para. Nesse caso, ou caso o produto falhe, o token é
+ * marcado como incompleto; quem chama deve consultar `token_incompleto`.
+ */
+
 //< Calcula sequencialmente o produto escalar `v1 * v2` entre dois vetores.
 long long produto_escalar_seq(const int* v1, const int* v2, size_t n);
 
 //< Calcula paralelamente o produto escalar `v1 * v2` entre dois vetores, dado um número de threads.
 long long produto_escalar_par(const int* v1, const int* v2, size_t n, int num_threads);
 
+//< Calcula o produto escalar `v1 * v2` dividido entre `num_processos` processos, com os vetores em memória compartilhada.
+long long produto_escalar_proc(const int* v1, const int* v2, size_t n, int num_processos);
+
 #endif // SCALAR_PRODUCT_H
@@ -1,24 +1,76 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+//< O tamanho de uma linha de cache (bytes).
+#define TAMANHO_LINHA_CACHE 64
+
+//< Alinha um campo/struct ao início de uma linha de cache. Em structs, usar
+// no primeiro campo faz com que cada instância ocupe linhas próprias.
+#define ALINHADO_CACHE _Alignas(TAMANHO_LINHA_CACHE)
+
+//< Valor de `Args.threads` quando passado `--threads auto`. Negativo para
+// não ser confundido com uma quantidade explícita.
+#define THREADS_AUTO -1
 
 /**
  * @brief Representa os argumentos passados para os programas que calculam
- * produto interno de vetores e produto de matrizes.
+ * produto interno de vetores, produto de matrizes e produto matriz-vetor.
  */
 typedef struct {
     //< O tamanho dos vetores/matrizes quadradas.
     size_t size;
 
-    //< A quantidade de threads a serem usadas.
+    //< A quantidade de threads (ou processos, no modo `PROC`) a serem
+    // usadas, ou `THREADS_AUTO`.
     int threads;
 
-    //< O modo de execução (sequencial ou paralelo)
-    enum { SEQ, PAR } mode;
+    //< O modo de execução (sequencial, paralelo, escolhido pelo modelo de
+    // custo ou dividido entre processos)
+    enum { SEQ, PAR, AUTO, PROC } mode;
+
+    //< Indica se o modo/threads foram escolhidos pelo modelo de custo.
+    bool decisao_automatica;
 
     //< A seed aleatória passada por argumento.
     unsigned int seed;
+
+    //< O arquivo onde os quadros da simulação serão gravados (ou `NULL`).
+    const char* gravar;
+
+    //< Descarta quadros quando o anel de gravação estiver cheio, ao invés
+    // de bloquear a renderização.
+    bool gravar_descartar;
+
+    //< Executa o ajuste automático dos blocos do produto de matrizes.
+    // Apenas o produto de matrizes aceita esta opção e `perfil`.
+    bool ajustar;
+
+    //< O arquivo de perfis do ajuste (ou `NULL` para o caminho padrão).
+    const char* perfil;
+
+    //< A quantidade de vetores à direita no produto matriz-vetor.
+    size_t rhs;
+
+    //< Calcula o produto matriz-vetor com a matriz transposta.
+    bool transposta;
+
+    //< O nome da memória compartilhada onde a simulação publica os tempos
+    // de cada quadro (ou `NULL`).
+    const char* metricas;
+
+    //< A fase ampla da detecção de colisões da simulação: todos os pares
+    // (força bruta) ou varredura dos círculos ordenados no eixo x.
+    enum { AMPLA_BRUTA, AMPLA_VARREDURA } fase_ampla;
+
+    //< A quantidade de círculos da simulação, ou `0` para `sqrt(size)`.
+    size_t circulos;
+
+    //< O prazo (s) para a operação principal terminar, ou `0` para não ter prazo.
+    double prazo;
 } Args;
 
 /**
@@ -32,7 +84,20 @@ typedef struct {
  */
 Args validar_argumentos(int argc, char* argv[]);
 
+//< Retorna o nome do modo de execução, como aceito por `--mode`.
+const char* nome_modo(const Args* args);
+
 //< Retorna o tempo atual em segundos.
 double tempo_segundos();
 
+//< Valor inicial de `hash_fnv1a`.
+#define HASH_INICIAL 0xcbf29ce484222325ULL
+
+/**
+ * @brief Acumula `n` bytes em um hash FNV-1a de 64 bits, para comparar
+ * resultados entre execuções (e.g. `seq` e `par`) sem imprimí-los.
+ * @param hash O hash acumulado até aqui, ou `HASH_INICIAL`.
+ */
+uint64_t hash_fnv1a(uint64_t hash, const void* dados, size_t n);
+
 #endif // UTILS_H
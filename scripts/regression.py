@@ -0,0 +1,283 @@
+"""
+Performance regression suite.
+
+Runs every binary in sequential and parallel modes, checks that the parallel
+outputs match the sequential reference (exact dot product, FNV-1a hash of
+the result matrix, FNV-1a hash of all the matrix-vector result vectors,
+hash of the first simulation frame) and compares the timings against a
+baseline stored per host in out/baselines/<host>.json.
+
+A case is flagged as a regression when a one-sided Mann-Whitney U test says
+the new samples are slower than the baseline (p < --alpha) and the median
+slowdown is larger than --min-slowdown, so noise alone does not fail a run.
+
+Usage:
+    python3 scripts/regression.py                     # compare (creates the baseline on first run)
+    python3 scripts/regression.py --update-baseline   # replace the baseline with this run
+    python3 scripts/regression.py --only sp,mv        # run a subset of the binaries
+
+Exits with 1 if any output mismatches or any case regressed.
+"""
+
+import argparse
+import datetime
+import json
+import math
+import os
+import platform
+import re
+import subprocess
+import sys
+
+# Configuration
+BASELINE_DIR = "out/baselines"
+SEED = 42
+THREADS = 4
+RUNS = 7
+SIM_RUNS = 5
+ALPHA = 0.01
+MIN_SLOWDOWN = 0.05
+
+# Each group has a reference configuration (the first one) and variants
+# whose check column must match it. Output format of every binary:
+# mode,size,threads,<time|fps>,<result|hash>,decisao
+GROUPS = [
+    {
+        "name": "sp",
+        "binary": "scalar_product",
+        "args": ["--size", "10000000"],
+        "configs": [["--mode", "seq"], ["--mode", "par", "--threads", "{t}"], ["--mode", "proc", "--threads", "{t}"]],
+    },
+    {
+        "name": "mp",
+        "binary": "matrix_product",
+        "args": ["--size", "512"],
+        "configs": [["--mode", "seq"], ["--mode", "par", "--threads", "{t}"], ["--mode", "proc", "--threads", "{t}"]],
+    },
+    {
+        "name": "mv",
+        "binary": "matrix_vector",
+        "args": ["--size", "2048", "--rhs", "4"],
+        "configs": [["--mode", "seq"], ["--mode", "par", "--threads", "{t}"]],
+    },
+    {
+        "name": "mv-t",
+        "binary": "matrix_vector",
+        "args": ["--size", "2048", "--rhs", "4", "--transpose"],
+        "configs": [["--mode", "seq"], ["--mode", "par", "--threads", "{t}"]],
+    },
+    {
+        "name": "sim",
+        "binary": "simulation",
+        "args": ["--size", "400"],
+        "configs": [["--mode", "seq"], ["--mode", "par", "--threads", "{t}"]],
+        # The simulation reports frames per second; it is stored as seconds
+        # per frame so that larger always means slower.
+        "fps": True,
+    },
+]
+
+
+def host_key():
+    cpu = platform.processor() or ""
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    cpu = line.split(":", 1)[1].strip()
+                    break
+    except OSError:
+        pass
+
+    key = f"{platform.node()}-{cpu}" if cpu else platform.node()
+    return re.sub(r"[^A-Za-z0-9_.-]+", "_", key).strip("_") or "unknown"
+
+
+def git_commit():
+    try:
+        result = subprocess.run(["git", "rev-parse", "--short", "HEAD"], capture_output=True, text=True)
+        return result.stdout.strip() if result.returncode == 0 else None
+    except OSError:
+        return None
+
+
+def case_key(group, config):
+    return " ".join([group["name"]] + group["args"] + config)
+
+
+def run_once(executable, args, env):
+    result = subprocess.run([executable] + args, capture_output=True, text=True, env=env)
+    if result.returncode != 0:
+        raise RuntimeError(f"{' '.join([executable] + args)} failed:\n{result.stderr.strip()}")
+
+    parts = result.stdout.strip().splitlines()[-1].split(",")
+    return float(parts[3]), parts[4]
+
+
+def run_group(group, build_dir, threads, runs):
+    executable = os.path.join(build_dir, group["binary"])
+    configs = [[arg.format(t=threads) for arg in config] for config in group["configs"]]
+
+    # Configure SDL to render to a fake device
+    env = os.environ.copy()
+    env["SDL_VIDEODRIVER"] = "dummy"
+
+    samples = {case_key(group, c): [] for c in configs}
+    checks = {case_key(group, c): set() for c in configs}
+
+    # Interleave the configurations so slow drifts (thermal, other load)
+    # affect all of them alike
+    for r in range(runs):
+        for config in configs:
+            key = case_key(group, config)
+            print(f"[{r + 1}/{runs}] {key}")
+            value, check = run_once(executable, group["args"] + config + ["--seed", str(SEED)], env)
+            samples[key].append(1.0 / value if group.get("fps") else value)
+            checks[key].add(check)
+
+    # Every configuration must reproduce the sequential reference exactly
+    reference = checks[case_key(group, configs[0])]
+    mismatches = []
+    for key, values in checks.items():
+        if len(values) != 1 or values != reference:
+            mismatches.append(f"{key}: {sorted(values)} != reference {sorted(reference)}")
+
+    return samples, mismatches
+
+
+def ranks(values):
+    """Average ranks (1-based) of `values`, with ties sharing their mean rank."""
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    result = [0.0] * len(values)
+    ties = []
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            result[order[k]] = (i + j) / 2 + 1
+        ties.append(j - i + 1)
+        i = j + 1
+    return result, ties
+
+
+def mann_whitney_greater(x, y):
+    """
+    One-sided Mann-Whitney U test with H1: values of `x` tend to be larger
+    than values of `y`. Uses the normal approximation with tie and
+    continuity corrections. Returns the p-value.
+    """
+    n1, n2 = len(x), len(y)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+
+    r, ties = ranks(list(x) + list(y))
+    u1 = sum(r[:n1]) - n1 * (n1 + 1) / 2
+    n = n1 + n2
+    tie_term = sum(t ** 3 - t for t in ties) / (n * (n - 1))
+    sigma = math.sqrt(n1 * n2 / 12 * ((n + 1) - tie_term))
+    if sigma == 0:
+        return 1.0
+
+    z = (u1 - n1 * n2 / 2 - 0.5) / sigma
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+
+def median(values):
+    s = sorted(values)
+    mid = len(s) // 2
+    return s[mid] if len(s) % 2 else (s[mid - 1] + s[mid]) / 2
+
+
+def compare(samples, baseline, alpha, min_slowdown):
+    regressions = []
+
+    print("\nComparison against baseline:")
+    print(f"{'Case':<60} {'Base':>12} {'Now':>12} {'Ratio':>8} {'p':>8}")
+    print("-" * 104)
+
+    for key, now in samples.items():
+        base = baseline.get(key)
+        if not base:
+            print(f"{key:<60} {'-':>12} {median(now):>12.6f} {'new':>8}")
+            continue
+
+        ratio = median(now) / median(base)
+        p = mann_whitney_greater(now, base)
+        flag = ""
+        if p < alpha and ratio > 1 + min_slowdown:
+            flag = "  SLOWER"
+            regressions.append(key)
+        elif mann_whitney_greater(base, now) < alpha and ratio < 1 - min_slowdown:
+            flag = "  faster"
+
+        print(f"{key:<60} {median(base):>12.6f} {median(now):>12.6f} {ratio:>8.3f} {p:>8.4f}{flag}")
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build", default="build", help="directory with the compiled binaries")
+    parser.add_argument("--threads", type=int, default=THREADS, help="threads/processes of the parallel modes")
+    parser.add_argument("--runs", type=int, default=RUNS, help="samples per case")
+    parser.add_argument("--sim-runs", type=int, default=SIM_RUNS, help="samples per simulation case")
+    parser.add_argument("--alpha", type=float, default=ALPHA, help="significance level of the slowdown test")
+    parser.add_argument("--min-slowdown", type=float, default=MIN_SLOWDOWN, help="smallest median slowdown reported")
+    parser.add_argument("--only", help="comma-separated groups to run (" + ",".join(g["name"] for g in GROUPS) + ")")
+    parser.add_argument("--baseline", help="baseline file (default: out/baselines/<host>.json)")
+    parser.add_argument("--update-baseline", action="store_true", help="replace the baseline with this run")
+    args = parser.parse_args()
+
+    groups = GROUPS
+    if args.only:
+        names = set(args.only.split(","))
+        groups = [g for g in GROUPS if g["name"] in names]
+
+    baseline_path = args.baseline or os.path.join(BASELINE_DIR, host_key() + ".json")
+
+    samples = {}
+    mismatches = []
+    for group in groups:
+        runs = args.sim_runs if group.get("fps") else args.runs
+        group_samples, group_mismatches = run_group(group, args.build, args.threads, runs)
+        samples.update(group_samples)
+        mismatches += group_mismatches
+
+    if mismatches:
+        print("\nOutput mismatches against the sequential reference:")
+        for m in mismatches:
+            print(f"  {m}")
+
+    baseline = None
+    if os.path.exists(baseline_path):
+        with open(baseline_path) as f:
+            baseline = json.load(f)
+
+    regressions = []
+    if baseline and not args.update_baseline:
+        regressions = compare(samples, baseline["results"], args.alpha, args.min_slowdown)
+
+    # Store the baseline on the first run, or when asked. Cases not run now are kept.
+    if (baseline is None or args.update_baseline) and not mismatches:
+        results = baseline["results"] if baseline else {}
+        results.update(samples)
+        os.makedirs(os.path.dirname(baseline_path) or ".", exist_ok=True)
+        with open(baseline_path, "w") as f:
+            json.dump({
+                "host": host_key(),
+                "commit": git_commit(),
+                "date": datetime.datetime.now().isoformat(timespec="seconds"),
+                "results": results,
+            }, f, indent=2)
+        print(f"\nBaseline written to {baseline_path}")
+
+    if regressions:
+        print(f"\n{len(regressions)} case(s) significantly slower than the baseline")
+
+    return 1 if mismatches or regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
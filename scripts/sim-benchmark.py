@@ -27,7 +27,7 @@ def run_benchmark():
             print(f"Error: {result.stderr}")
             continue
 
-        # Output format: mode,size,threads,fps
+        # Output format: mode,size,threads,fps,hash,decisao
         parts = result.stdout.strip().split(',')
         results.append({"mode": "seq", "size": size, "threads": 1, "fps": float(parts[3])})
 
@@ -41,7 +41,7 @@ def run_benchmark():
                 print(f"Error: {result.stderr}")
                 continue
             
-            # Output format: mode,size,threads,fps
+            # Output format: mode,size,threads,fps,hash,decisao
             parts = result.stdout.strip().split(',')
             results.append({"mode": "par", "size": size, "threads": t, "fps": float(parts[3])})
             
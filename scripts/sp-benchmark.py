@@ -25,7 +25,7 @@ def run_benchmark():
             if result.returncode != 0:
                 print(f"Error: {result.stderr}")
                 continue
-            # Output format: mode,size,threads,time,result
+            # Output format: mode,size,threads,time,result,decisao
             parts = result.stdout.strip().split(',')
             times.append(float(parts[3]))
         
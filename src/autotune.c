@@ -0,0 +1,318 @@
+#include "autotune.h"
+#include "log.h"
+#include "matrix_product.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+//< Tamanho máximo de uma linha do arquivo de perfis.
+#define TAMANHO_LINHA 512
+
+//< Quantas vezes cada formato é medido; o menor tempo é mantido.
+#define REPETICOES 2
+
+//< Um formato `m x k` * `k x n` usado nas medições.
+typedef struct {
+    size_t m, k, n;
+} Formato;
+
+//< Formatos representativos: quadrados pequenos/médios e um produto "magro".
+static const Formato formatos[] = {
+    { 256, 256, 256 },
+    { 512, 512, 512 },
+    { 128, 1024, 128 },
+};
+
+//< Os valores candidatos de cada parâmetro, varridos um de cada vez.
+static const size_t candidatos_k[] = { 32, 64, 128, 256, 512 };
+static const size_t candidatos_j[] = { 64, 128, 256, 512, 1024 };
+static const size_t candidatos_i[] = { 8, 16, 32, 64 };
+static const int candidatos_desenrolar[] = { 1, 2, 4 };
+
+#define QTD(v) (sizeof(v) / sizeof((v)[0]))
+
+//< Lê a primeira linha de um arquivo em `buffer`, sem a quebra de linha.
+static int ler_linha_arquivo(const char* caminho, char* buffer, size_t tamanho) {
+    FILE* f = fopen(caminho, "r");
+    if (!f) return 0;
+
+    int ok = fgets(buffer, tamanho, f) != NULL;
+    fclose(f);
+
+    if (ok) buffer[strcspn(buffer, "\n")] = '\0';
+    return ok;
+}
+
+//< Obtém o modelo da CPU a partir de `/proc/cpuinfo`.
+static void modelo_cpu(char* modelo, size_t tamanho) {
+    snprintf(modelo, tamanho, "desconhecida");
+
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+
+    char linha[TAMANHO_LINHA];
+    while (fgets(linha, sizeof(linha), f)) {
+        // x86 usa "model name"; ARM usa "CPU part" (ou "Processor" em kernels antigos)
+        if (strncmp(linha, "model name", 10) == 0 || strncmp(linha, "Processor", 9) == 0
+            || strncmp(linha, "CPU part", 8) == 0) {
+            char* valor = strchr(linha, ':');
+            if (!valor) continue;
+
+            valor += strspn(valor, ": \t");
+            valor[strcspn(valor, "\n")] = '\0';
+            snprintf(modelo, tamanho, "%s", valor);
+            break;
+        }
+    }
+
+    fclose(f);
+}
+
+//< Obtém o tamanho da cache de dados de um nível a partir do `sysfs`.
+static void tamanho_cache(int nivel, char* tamanho_cache, size_t tamanho) {
+    snprintf(tamanho_cache, tamanho, "?");
+
+    for (int indice = 0; indice < 8; indice++) {
+        char caminho[128];
+        char valor[64];
+
+        snprintf(caminho, sizeof(caminho), "/sys/devices/system/cpu/cpu0/cache/index%d/level", indice);
+        if (!ler_linha_arquivo(caminho, valor, sizeof(valor)))
+            break;
+        if (atoi(valor) != nivel)
+            continue;
+
+        snprintf(caminho, sizeof(caminho), "/sys/devices/system/cpu/cpu0/cache/index%d/type", indice);
+        if (!ler_linha_arquivo(caminho, valor, sizeof(valor)) || strcmp(valor, "Instruction") == 0)
+            continue;
+
+        // Ler o tamanho diretamente no destino, mantendo "?" em caso de falha
+        snprintf(caminho, sizeof(caminho), "/sys/devices/system/cpu/cpu0/cache/index%d/size", indice);
+        if (!ler_linha_arquivo(caminho, tamanho_cache, tamanho))
+            snprintf(tamanho_cache, tamanho, "?");
+        return;
+    }
+}
+
+void identificar_maquina(char* chave, size_t tamanho) {
+    char modelo[256], l1[32], l2[32], l3[32];
+    modelo_cpu(modelo, sizeof(modelo));
+    tamanho_cache(1, l1, sizeof(l1));
+    tamanho_cache(2, l2, sizeof(l2));
+    tamanho_cache(3, l3, sizeof(l3));
+
+    snprintf(chave, tamanho, "%s|L1d=%s|L2=%s|L3=%s", modelo, l1, l2, l3);
+
+    // A chave é separada da configuração por um `\t` no arquivo
+    for (char* c = chave; *c; c++)
+        if (*c == '\t') *c = ' ';
+}
+
+const char* caminho_perfil_padrao(void) {
+    static char caminho[TAMANHO_LINHA];
+
+    const char* cache = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+
+    if (cache && *cache) {
+        snprintf(caminho, sizeof(caminho), "%s/matrix_product.perfil", cache);
+    } else if (home && *home) {
+        snprintf(caminho, sizeof(caminho), "%s/.cache/matrix_product.perfil", home);
+    } else {
+        snprintf(caminho, sizeof(caminho), "matrix_product.perfil");
+    }
+
+    return caminho;
+}
+
+int carregar_perfil(const char* caminho) {
+    FILE* f = fopen(caminho, "r");
+    if (!f) return 0;
+
+    char chave[TAMANHO_LINHA];
+    identificar_maquina(chave, sizeof(chave));
+    size_t tamanho_chave = strlen(chave);
+
+    int encontrado = 0;
+    char linha[TAMANHO_LINHA];
+    while (!encontrado && fgets(linha, sizeof(linha), f)) {
+        if (strncmp(linha, chave, tamanho_chave) != 0 || linha[tamanho_chave] != '\t')
+            continue;
+
+        config_blocos_t config;
+        if (sscanf(linha + tamanho_chave + 1, "%zu %zu %zu %d",
+                &config.bloco_i, &config.bloco_j, &config.bloco_k, &config.desenrolar) == 4) {
+            // Perfis com blocos inválidos (e.g. maiores que `MAX_ELEMENTOS_BLOCO`) são ignorados
+            encontrado = definir_config_blocos(config);
+        }
+    }
+
+    fclose(f);
+
+#ifndef NDEBUG
+    if (encontrado) {
+        config_blocos_t c = obter_config_blocos();
+        fprintf(stderr, VERDE("DEBUG") "\tPerfil: blocos %zux%zux%zu, desenrolar %d\n",
+            c.bloco_i, c.bloco_j, c.bloco_k, c.desenrolar);
+    }
+#endif
+
+    return encontrado;
+}
+
+//< Matrizes pré-alocadas para as medições de um formato.
+typedef struct {
+    matriz_t *a, *b, *c;
+} Operandos;
+
+/**
+ * Mede o tempo total (menor de `REPETICOES`) de todos os formatos com uma
+ * configuração, ou retorna `-1` caso algum produto falhe (e.g. interrompido
+ * por `SIGINT` ou pelo prazo), para que um tempo parcial nunca seja salvo.
+ */
+static double medir(const Operandos* operandos, config_blocos_t config) {
+    if (!definir_config_blocos(config))
+        return -1;
+
+    double total = 0;
+    for (size_t f = 0; f < QTD(formatos); f++) {
+        double melhor = -1;
+
+        for (int r = 0; r < REPETICOES; r++) {
+            double inicio = tempo_segundos();
+            if (!gemm_seq(1, visao_matriz(operandos[f].a), visao_matriz(operandos[f].b), 0, visao_matriz(operandos[f].c)))
+                return -1;
+            double tempo = tempo_segundos() - inicio;
+
+            if (melhor < 0 || tempo < melhor) melhor = tempo;
+        }
+
+        total += melhor;
+    }
+
+    return total;
+}
+
+//< Varre os candidatos de um parâmetro de `melhor`, mantendo o valor mais rápido.
+#define VARRER(campo, candidatos) do {                                      \
+    for (size_t v = 0; v < QTD(candidatos); v++) {                          \
+        config_blocos_t teste = *melhor;                                    \
+        teste.campo = candidatos[v];                                        \
+        if (teste.campo == melhor->campo) continue;                         \
+                                                                            \
+        double tempo = medir(operandos, teste);                             \
+        if (tempo < 0)                                                      \
+            return 0;                                                       \
+        if (tempo < *melhor_tempo) {                                        \
+            *melhor = teste;                                                \
+            *melhor_tempo = tempo;                                          \
+        }                                                                   \
+    }                                                                       \
+    fprintf(stderr, CIANO("INFO") "\t" #campo " = %zu (%.4fs)\n",          \
+        (size_t)melhor->campo, *melhor_tempo);                              \
+} while (0)
+
+//< Busca por coordenadas: otimiza um parâmetro por vez, a partir do atual. Retorna `0` caso alguma medição falhe.
+static int buscar(const Operandos* operandos, config_blocos_t* melhor, double* melhor_tempo) {
+    VARRER(bloco_k, candidatos_k);
+    VARRER(bloco_j, candidatos_j);
+    VARRER(bloco_i, candidatos_i);
+    VARRER(desenrolar, candidatos_desenrolar);
+    return 1;
+}
+
+//< Cria o diretório pai de `caminho`, caso ainda não exista.
+static void criar_diretorio_pai(const char* caminho) {
+    char diretorio[TAMANHO_LINHA];
+    snprintf(diretorio, sizeof(diretorio), "%s", caminho);
+
+    char* barra = strrchr(diretorio, '/');
+    if (!barra || barra == diretorio) return;
+
+    *barra = '\0';
+    if (mkdir(diretorio, 0755) != 0 && errno != EEXIST)
+        fprintf(stderr, AMARELO("AVISO") "\tNão foi possível criar '%s'\n", diretorio);
+}
+
+//< Reescreve o arquivo de perfis trocando (ou adicionando) a linha desta máquina.
+static int salvar_perfil(const char* caminho, const char* chave, config_blocos_t config) {
+    char temporario[TAMANHO_LINHA + 8];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+
+    criar_diretorio_pai(caminho);
+    FILE* saida = fopen(temporario, "w");
+    if (!saida) {
+        fprintf(stderr, VERMELHO("ERRO") "\tNão foi possível escrever '%s'\n", temporario);
+        return 0;
+    }
+
+    // Manter os perfis das outras máquinas
+    size_t tamanho_chave = strlen(chave);
+    FILE* entrada = fopen(caminho, "r");
+    if (entrada) {
+        char linha[TAMANHO_LINHA];
+        while (fgets(linha, sizeof(linha), entrada)) {
+            if (strncmp(linha, chave, tamanho_chave) == 0 && linha[tamanho_chave] == '\t')
+                continue;
+            fputs(linha, saida);
+        }
+        fclose(entrada);
+    }
+
+    fprintf(saida, "%s\t%zu %zu %zu %d\n", chave, config.bloco_i, config.bloco_j, config.bloco_k, config.desenrolar);
+
+    if (fclose(saida) != 0 || rename(temporario, caminho) != 0) {
+        fprintf(stderr, VERMELHO("ERRO") "\tNão foi possível salvar o perfil em '%s'\n", caminho);
+        remove(temporario);
+        return 0;
+    }
+
+    return 1;
+}
+
+int ajustar_blocos(const char* caminho) {
+    char chave[TAMANHO_LINHA];
+    identificar_maquina(chave, sizeof(chave));
+    fprintf(stderr, CIANO("INFO") "\tAjustando blocos para '%s'\n", chave);
+
+    Operandos operandos[QTD(formatos)] = { 0 };
+    int ok = 1;
+    for (size_t f = 0; f < QTD(formatos); f++) {
+        operandos[f].a = gerar_matriz(formatos[f].m, formatos[f].k, -10, 10);
+        operandos[f].b = gerar_matriz(formatos[f].k, formatos[f].n, -10, 10);
+        operandos[f].c = criar_matriz_sem_zerar(formatos[f].m, formatos[f].n);
+        ok = ok && operandos[f].a && operandos[f].b && operandos[f].c;
+    }
+
+    if (ok) {
+        config_blocos_t original = obter_config_blocos();
+        config_blocos_t melhor = original;
+        double melhor_tempo = medir(operandos, melhor);
+
+        if (melhor_tempo >= 0 && buscar(operandos, &melhor, &melhor_tempo)) {
+            definir_config_blocos(melhor);
+            ok = salvar_perfil(caminho, chave, melhor);
+
+            fprintf(stderr, CIANO("INFO") "\tMelhor: blocos %zux%zux%zu, desenrolar %d (%.4fs) -> %s\n",
+                melhor.bloco_i, melhor.bloco_j, melhor.bloco_k, melhor.desenrolar, melhor_tempo, caminho);
+        } else {
+            // Medições interrompidas não representam a máquina: manter o perfil anterior
+            definir_config_blocos(original);
+            ok = 0;
+            fprintf(stderr, VERMELHO("ERRO") "\tAjuste interrompido; nenhum perfil foi salvo\n");
+        }
+    } else {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao alocar as matrizes do ajuste\n");
+    }
+
+    for (size_t f = 0; f < QTD(formatos); f++) {
+        free_matriz(operandos[f].a);
+        free_matriz(operandos[f].b);
+        free_matriz(operandos[f].c);
+    }
+
+    return ok;
+}
@@ -0,0 +1,84 @@
+#include "cancelamento.h"
+#include <signal.h>
+#include <stddef.h>
+#include <time.h>
+
+//< O token da operação em andamento.
+static TokenParada operacao = { .parado = false, .prazo = 0, .pai = NULL, .incompleto = false };
+
+//< Retorna um instante (s) de um relógio monotônico, imune a ajustes do relógio do sistema.
+static double relogio_monotonico(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void token_iniciar(TokenParada* token, TokenParada* pai, double segundos) {
+    atomic_init(&token->parado, false);
+    token->prazo = segundos > 0 ? relogio_monotonico() + segundos : 0;
+    token->pai = pai;
+    atomic_init(&token->incompleto, false);
+}
+
+void token_cancelar(TokenParada* token) {
+    atomic_store_explicit(&token->parado, true, memory_order_relaxed);
+}
+
+bool token_parado(TokenParada* token) {
+    for (TokenParada* t = token; t; t = t->pai) {
+        if (atomic_load_explicit(&t->parado, memory_order_relaxed))
+            return true;
+
+        // Guardar a expiração do prazo, para que as próximas consultas não leiam o relógio
+        if (t->prazo > 0 && relogio_monotonico() >= t->prazo) {
+            token_cancelar(t);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void token_marcar_incompleto(TokenParada* token) {
+    atomic_store_explicit(&token->incompleto, true, memory_order_relaxed);
+}
+
+bool token_incompleto(const TokenParada* token) {
+    // Consultado após `pthread_join`, que já ordena as marcações das threads
+    return atomic_load_explicit(&token->incompleto, memory_order_relaxed);
+}
+
+double token_restante(const TokenParada* token) {
+    double restante = -1;
+
+    for (const TokenParada* t = token; t; t = t->pai) {
+        if (t->prazo <= 0)
+            continue;
+
+        double r = t->prazo - relogio_monotonico();
+        r = r > 0 ? r : 0;
+        if (restante < 0 || r < restante)
+            restante = r;
+    }
+
+    return restante;
+}
+
+TokenParada* token_operacao(void) {
+    return &operacao;
+}
+
+void definir_prazo_operacao(double segundos) {
+    // Um cancelamento já recebido (e.g. `SIGINT` durante a calibração) é mantido
+    operacao.prazo = segundos > 0 ? relogio_monotonico() + segundos : 0;
+}
+
+//< Cancela a operação no primeiro `SIGINT` e volta ao comportamento padrão para o próximo.
+static void tratar_sinal(int sinal) {
+    token_cancelar(&operacao);
+    signal(sinal, SIG_DFL);
+}
+
+void instalar_cancelamento_sinal(void) {
+    signal(SIGINT, tratar_sinal);
+}
@@ -0,0 +1,256 @@
+#include "frame_metrics.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+//< Identificam a memória compartilhada das métricas ("SIMM").
+#define MAGICA_METRICAS 0x4d4d4953u
+#define VERSAO_METRICAS 3
+
+//< Tamanho máximo do nome de uma memória compartilhada.
+#define TAMANHO_NOME_METRICAS 64
+
+struct MetricasQuadro {
+    char nome[TAMANHO_NOME_METRICAS];
+    MetricasCompartilhadas* memoria;
+};
+
+uint64_t agora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+const char* nome_fase(fase_quadro_t fase) {
+    switch (fase) {
+    case FASE_FISICA: return "fisica";
+    case FASE_RENDER: return "render";
+    case FASE_ESPERA: return "espera";
+    case FASE_GRAVACAO: return "gravacao";
+    case FASE_BLIT: return "blit";
+    case FASE_APRESENTAR: return "apresentar";
+    case FASE_QUADRO: return "quadro";
+    default: return "?";
+    }
+}
+
+//< Retorna o índice do balde de `valor`.
+static size_t indice_balde(uint64_t valor) {
+    if (valor < HISTOGRAMA_SUB)
+        return valor;
+
+    if (valor >= (1ull << HISTOGRAMA_EXPOENTES))
+        valor = (1ull << HISTOGRAMA_EXPOENTES) - 1;
+
+    // O grupo `g >= 1` cobre `[2^(g + BITS_SUB - 1), 2^(g + BITS_SUB))` com baldes de largura `2^g`
+    int expoente = 63 - __builtin_clzll(valor);
+    int grupo = expoente - HISTOGRAMA_BITS_SUB + 1;
+    size_t sub = (valor >> grupo) - HISTOGRAMA_SUB / 2;
+    return HISTOGRAMA_SUB + (grupo - 1) * (HISTOGRAMA_SUB / 2) + sub;
+}
+
+//< Retorna o maior valor contido no balde `indice`.
+static uint64_t limite_balde(size_t indice) {
+    if (indice < HISTOGRAMA_SUB)
+        return indice;
+
+    size_t grupo = (indice - HISTOGRAMA_SUB) / (HISTOGRAMA_SUB / 2) + 1;
+    size_t sub = (indice - HISTOGRAMA_SUB) % (HISTOGRAMA_SUB / 2);
+    uint64_t largura = 1ull << grupo;
+    return (HISTOGRAMA_SUB / 2 + sub) * largura + largura - 1;
+}
+
+void histograma_registrar(HistogramaLatencia* h, uint64_t valor) {
+    // Com um único escritor, carregar e armazenar evita o custo de uma
+    // operação atômica de leitura-escrita, e o leitor nunca vê valores parciais
+    _Atomic uint64_t* balde = &h->baldes[indice_balde(valor)];
+    atomic_store_explicit(balde, atomic_load_explicit(balde, memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_store_explicit(&h->total, atomic_load_explicit(&h->total, memory_order_relaxed) + 1, memory_order_relaxed);
+
+    if (valor > atomic_load_explicit(&h->maximo, memory_order_relaxed))
+        atomic_store_explicit(&h->maximo, valor, memory_order_relaxed);
+}
+
+uint64_t histograma_percentil(const HistogramaLatencia* h, double p) {
+    // Os baldes podem estar à frente do total lido, mas nunca atrás
+    uint64_t total = atomic_load_explicit(&h->total, memory_order_relaxed);
+    if (total == 0)
+        return 0;
+
+    uint64_t alvo = (uint64_t)(p * total + 0.5);
+    if (alvo < 1) alvo = 1;
+    if (alvo > total) alvo = total;
+
+    uint64_t acumulado = 0;
+    for (size_t i = 0; i < HISTOGRAMA_BALDES; i++) {
+        acumulado += atomic_load_explicit(&h->baldes[i], memory_order_relaxed);
+        if (acumulado >= alvo) {
+            uint64_t limite = limite_balde(i);
+            uint64_t maximo = atomic_load_explicit(&h->maximo, memory_order_relaxed);
+            return limite < maximo ? limite : maximo;
+        }
+    }
+
+    return atomic_load_explicit(&h->maximo, memory_order_relaxed);
+}
+
+//< Copia `nome` para `destino`, prefixando `/` como exigido por `shm_open`.
+static void normalizar_nome(char* destino, size_t tamanho, const char* nome) {
+    snprintf(destino, tamanho, "%s%s", nome[0] == '/' ? "" : "/", nome);
+}
+
+MetricasQuadro* metricas_criar(const char* nome, int threads) {
+    MetricasQuadro* m = calloc(1, sizeof(MetricasQuadro));
+    if (!m) {
+        perror("Falha ao alocar métricas");
+        return NULL;
+    }
+    normalizar_nome(m->nome, sizeof(m->nome), nome);
+
+    // Uma memória antiga de mesmo nome (de uma execução interrompida) é substituída
+    shm_unlink(m->nome);
+    int fd = shm_open(m->nome, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao criar métricas '%s': %s\n", m->nome, strerror(errno));
+        free(m);
+        return NULL;
+    }
+
+    if (ftruncate(fd, sizeof(MetricasCompartilhadas)) != 0) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao dimensionar métricas: %s\n", strerror(errno));
+        close(fd);
+        shm_unlink(m->nome);
+        free(m);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, sizeof(MetricasCompartilhadas), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao mapear métricas: %s\n", strerror(errno));
+        shm_unlink(m->nome);
+        free(m);
+        return NULL;
+    }
+
+    // A memória recém-criada já é zerada; preencher o cabeçalho por último
+    m->memoria = base;
+    m->memoria->threads = threads < MAX_THREADS_METRICAS ? threads : MAX_THREADS_METRICAS;
+    m->memoria->versao = VERSAO_METRICAS;
+    atomic_store_explicit(&m->memoria->ativo, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    m->memoria->magica = MAGICA_METRICAS;
+    return m;
+}
+
+void metricas_registrar(MetricasQuadro* m, const RegistroQuadro* registro) {
+    MetricasCompartilhadas* memoria = m->memoria;
+
+    for (int f = 0; f < FASES_QUADRO; f++)
+        histograma_registrar(&memoria->fases[f], registro->fases[f]);
+    for (uint32_t t = 0; t < memoria->threads; t++)
+        histograma_registrar(&memoria->render[t], registro->render[t]);
+
+    uint64_t escritos = atomic_load_explicit(&memoria->escritos, memory_order_relaxed);
+    EntradaAnelMetricas* entrada = &memoria->anel[escritos % CAPACIDADE_ANEL_METRICAS];
+    uint64_t sequencia = 2 * (escritos / CAPACIDADE_ANEL_METRICAS);
+
+    uint64_t palavras[PALAVRAS_REGISTRO];
+    memcpy(palavras, registro, sizeof(palavras));
+
+    // Marcar a entrada como em escrita (ímpar) antes de qualquer palavra ser
+    // sobrescrita: a barreira impede que as escritas seguintes a ultrapassem
+    atomic_store_explicit(&entrada->sequencia, sequencia + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (size_t i = 0; i < PALAVRAS_REGISTRO; i++)
+        atomic_store_explicit(&entrada->palavras[i], palavras[i], memory_order_relaxed);
+
+    // Concluir a entrada e então publicá-la em `escritos`
+    atomic_store_explicit(&entrada->sequencia, sequencia + 2, memory_order_release);
+    atomic_store_explicit(&memoria->escritos, escritos + 1, memory_order_release);
+}
+
+void metricas_destruir(MetricasQuadro* m) {
+    if (!m)
+        return;
+
+    atomic_store_explicit(&m->memoria->ativo, 0, memory_order_release);
+    munmap(m->memoria, sizeof(MetricasCompartilhadas));
+    shm_unlink(m->nome);
+    free(m);
+}
+
+const MetricasCompartilhadas* metricas_abrir(const char* nome) {
+    char caminho[TAMANHO_NOME_METRICAS];
+    normalizar_nome(caminho, sizeof(caminho), nome);
+
+    int fd = shm_open(caminho, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+
+    void* base = mmap(NULL, sizeof(MetricasCompartilhadas), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return NULL;
+
+    const MetricasCompartilhadas* m = base;
+    if (m->magica != MAGICA_METRICAS || m->versao != VERSAO_METRICAS) {
+        munmap(base, sizeof(MetricasCompartilhadas));
+        return NULL;
+    }
+
+    atomic_thread_fence(memory_order_acquire);
+    return m;
+}
+
+void metricas_fechar(const MetricasCompartilhadas* m) {
+    if (m)
+        munmap((void*)m, sizeof(MetricasCompartilhadas));
+}
+
+size_t metricas_ler(const MetricasCompartilhadas* m, uint64_t* proximo, RegistroQuadro* destino, size_t max,
+    uint64_t* perdidos) {
+    uint64_t escritos = atomic_load_explicit(&m->escritos, memory_order_acquire);
+
+    // Registros mais antigos que a capacidade do anel já foram sobrescritos
+    if (escritos - *proximo > CAPACIDADE_ANEL_METRICAS) {
+        *perdidos += escritos - CAPACIDADE_ANEL_METRICAS - *proximo;
+        *proximo = escritos - CAPACIDADE_ANEL_METRICAS;
+    }
+
+    size_t copiados = 0;
+    while (*proximo < escritos && copiados < max) {
+        const EntradaAnelMetricas* entrada = &m->anel[*proximo % CAPACIDADE_ANEL_METRICAS];
+        uint64_t esperada = 2 * (*proximo / CAPACIDADE_ANEL_METRICAS + 1);
+
+        // A entrada deve conter exatamente este registro, já concluído
+        uint64_t antes = atomic_load_explicit(&entrada->sequencia, memory_order_acquire);
+
+        uint64_t palavras[PALAVRAS_REGISTRO];
+        for (size_t i = 0; i < PALAVRAS_REGISTRO; i++)
+            palavras[i] = atomic_load_explicit(&entrada->palavras[i], memory_order_relaxed);
+
+        // Caso o escritor tenha começado a sobrescrever a entrada durante a cópia, a cópia é inválida
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t depois = atomic_load_explicit(&entrada->sequencia, memory_order_relaxed);
+
+        if (antes == esperada && depois == esperada) {
+            memcpy(&destino[copiados], palavras, sizeof(palavras));
+            copiados++;
+        } else {
+            (*perdidos)++;
+        }
+
+        (*proximo)++;
+    }
+
+    return copiados;
+}
@@ -0,0 +1,280 @@
+#include "gravador.h"
+#include "log.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//< Tamanho do buffer do `FILE*`, para que o disco receba escritas grandes e sequenciais.
+#define TAMANHO_BUFFER_ARQUIVO (8u << 20)
+
+struct Gravador {
+    //< O arquivo de saída e seu buffer.
+    FILE* arquivo;
+    char* buffer_arquivo;
+    formato_gravacao_t formato;
+
+    //< As dimensões dos quadros.
+    int largura, altura;
+    size_t pixels_por_quadro;
+
+    //< O anel de quadros pré-alocados, com `capacidade` quadros contíguos.
+    uint32_t* anel;
+    size_t capacidade;
+
+    //< Quantidade de quadros já produzidos/consumidos. O anel está cheio
+    // quando `produzidos - consumidos == capacidade`.
+    size_t produzidos;
+    size_t consumidos;
+
+    //< Sincronização entre o renderizador e a thread de escrita.
+    pthread_mutex_t trava;
+    pthread_cond_t tem_quadro;
+    pthread_cond_t tem_espaco;
+    int encerrar;
+    int descartar;
+
+    //< Buffers de trabalho da thread de escrita (conversão/compressão).
+    uint32_t* anterior;
+    void* saida;
+
+    pthread_t thread;
+    EstatisticasGravacao estatisticas;
+};
+
+formato_gravacao_t formato_por_extensao(const char* caminho) {
+    const char* ext = strrchr(caminho, '.');
+    if (ext && strcmp(ext, ".y4m") == 0) return GRAVACAO_Y4M;
+    if (ext && strcmp(ext, ".rle") == 0) return GRAVACAO_DELTA;
+    return GRAVACAO_RAW;
+}
+
+//< Converte um quadro RGBA8888 para os planos Y, U e V (BT.601, faixa limitada).
+static void converter_yuv444(const uint32_t* quadro, size_t n, uint8_t* planos) {
+    uint8_t* py = planos;
+    uint8_t* pu = planos + n;
+    uint8_t* pv = planos + 2 * n;
+
+    for (size_t i = 0; i < n; i++) {
+        int r = (quadro[i] >> 24) & 0xFF;
+        int g = (quadro[i] >> 16) & 0xFF;
+        int b = (quadro[i] >> 8) & 0xFF;
+
+        py[i] = (uint8_t)(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        pu[i] = (uint8_t)(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+        pv[i] = (uint8_t)(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+    }
+}
+
+/**
+ * Codifica `quadro XOR anterior` como uma sequência de pares
+ * `[qtd. inalterados][qtd. literais][literais...]`, retornando a quantidade
+ * de palavras de 32 bits escritas em `saida`. No pior caso (píxeis alternando
+ * entre iguais e diferentes) são geradas `2n + 2` palavras.
+ */
+static size_t codificar_delta(const uint32_t* quadro, const uint32_t* anterior, size_t n, uint32_t* saida) {
+    size_t escritos = 0;
+    size_t i = 0;
+
+    while (i < n) {
+        size_t inicio = i;
+        while (i < n && quadro[i] == anterior[i]) i++;
+        uint32_t iguais = (uint32_t)(i - inicio);
+
+        inicio = i;
+        while (i < n && quadro[i] != anterior[i]) i++;
+        uint32_t literais = (uint32_t)(i - inicio);
+
+        saida[escritos++] = iguais;
+        saida[escritos++] = literais;
+        for (size_t k = inicio; k < i; k++)
+            saida[escritos++] = quadro[k] ^ anterior[k];
+    }
+
+    return escritos;
+}
+
+//< Escreve um único quadro no formato do gravador, retornando `1` em caso de sucesso.
+static int escrever_quadro(Gravador* g, const uint32_t* quadro) {
+    size_t n = g->pixels_por_quadro;
+
+    switch (g->formato) {
+    case GRAVACAO_RAW:
+        return fwrite(quadro, sizeof(uint32_t), n, g->arquivo) == n;
+
+    case GRAVACAO_Y4M:
+        converter_yuv444(quadro, n, g->saida);
+        return fputs("FRAME\n", g->arquivo) >= 0 && fwrite(g->saida, 3, n, g->arquivo) == n;
+
+    case GRAVACAO_DELTA: {
+        uint32_t* saida = g->saida;
+        size_t palavras = codificar_delta(quadro, g->anterior, n, saida + 1);
+        saida[0] = (uint32_t)palavras;
+        memcpy(g->anterior, quadro, n * sizeof(uint32_t));
+        return fwrite(saida, sizeof(uint32_t), palavras + 1, g->arquivo) == palavras + 1;
+    }
+    }
+
+    return 0;
+}
+
+//< A função principal da thread de escrita: consome o anel até o encerramento.
+static void* gravador_thread_main(void* arg) {
+    Gravador* g = arg;
+
+    pthread_mutex_lock(&g->trava);
+    while (true) {
+        while (g->consumidos == g->produzidos && !g->encerrar)
+            pthread_cond_wait(&g->tem_quadro, &g->trava);
+
+        if (g->consumidos == g->produzidos)
+            break;
+
+        const uint32_t* quadro = g->anel + (g->consumidos % g->capacidade) * g->pixels_por_quadro;
+        pthread_mutex_unlock(&g->trava);
+
+        // O quadro só é reutilizado pelo renderizador após `consumidos` avançar
+        int ok = !g->estatisticas.erro_escrita && escrever_quadro(g, quadro);
+
+        pthread_mutex_lock(&g->trava);
+        if (ok) g->estatisticas.gravados++;
+        else g->estatisticas.erro_escrita = 1;
+
+        g->consumidos++;
+        pthread_cond_signal(&g->tem_espaco);
+    }
+    pthread_mutex_unlock(&g->trava);
+
+    return NULL;
+}
+
+//< Libera os recursos de um gravador (parcialmente) inicializado.
+static void liberar_gravador(Gravador* g) {
+    if (g->arquivo) fclose(g->arquivo);
+    free(g->buffer_arquivo);
+    free(g->anel);
+    free(g->anterior);
+    free(g->saida);
+    free(g);
+}
+
+Gravador* gravador_criar(const char* caminho, int largura, int altura, int fps, size_t capacidade, int descartar) {
+    Gravador* g = calloc(1, sizeof(Gravador));
+    if (!g) {
+        perror("Falha ao alocar gravador");
+        return NULL;
+    }
+
+    g->formato = formato_por_extensao(caminho);
+    g->largura = largura;
+    g->altura = altura;
+    g->pixels_por_quadro = (size_t)largura * altura;
+    g->capacidade = capacidade < 2 ? 2 : capacidade;
+    g->descartar = descartar;
+
+    size_t bytes_anel = g->capacidade * g->pixels_por_quadro * sizeof(uint32_t);
+    g->anel = malloc(bytes_anel);
+    g->buffer_arquivo = malloc(TAMANHO_BUFFER_ARQUIVO);
+
+    if (g->formato == GRAVACAO_Y4M) {
+        g->saida = malloc(3 * g->pixels_por_quadro);
+    } else if (g->formato == GRAVACAO_DELTA) {
+        g->saida = malloc((2 * g->pixels_por_quadro + 3) * sizeof(uint32_t));
+        g->anterior = calloc(g->pixels_por_quadro, sizeof(uint32_t));
+    }
+
+    if (!g->anel || !g->buffer_arquivo
+        || (g->formato != GRAVACAO_RAW && !g->saida)
+        || (g->formato == GRAVACAO_DELTA && !g->anterior)) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao alocar o anel de gravação (%zu quadros)\n", g->capacidade);
+        liberar_gravador(g);
+        return NULL;
+    }
+
+    // Tocar todas as páginas agora, para não gerar page faults durante a renderização
+    memset(g->anel, 0, bytes_anel);
+
+    if (!(g->arquivo = fopen(caminho, "wb"))) {
+        fprintf(stderr, VERMELHO("ERRO") "\tNão foi possível abrir '%s' para gravação\n", caminho);
+        liberar_gravador(g);
+        return NULL;
+    }
+    setvbuf(g->arquivo, g->buffer_arquivo, _IOFBF, TAMANHO_BUFFER_ARQUIVO);
+
+    // Escrever o cabeçalho do formato escolhido
+    if (g->formato == GRAVACAO_Y4M)
+        fprintf(g->arquivo, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", largura, altura, fps);
+    else if (g->formato == GRAVACAO_DELTA)
+        fprintf(g->arquivo, "SIMRLE1 %d %d %d\n", largura, altura, fps);
+
+    pthread_mutex_init(&g->trava, NULL);
+    pthread_cond_init(&g->tem_quadro, NULL);
+    pthread_cond_init(&g->tem_espaco, NULL);
+
+    int rc = pthread_create(&g->thread, NULL, gravador_thread_main, g);
+    if (rc != 0) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao criar thread de gravação: %s\n", strerror(rc));
+        pthread_mutex_destroy(&g->trava);
+        pthread_cond_destroy(&g->tem_quadro);
+        pthread_cond_destroy(&g->tem_espaco);
+        liberar_gravador(g);
+        return NULL;
+    }
+
+    return g;
+}
+
+int gravador_enviar(Gravador* g, const void* pixels, size_t pitch) {
+    pthread_mutex_lock(&g->trava);
+    g->estatisticas.enviados++;
+
+    if (g->produzidos - g->consumidos == g->capacidade) {
+        if (g->descartar) {
+            g->estatisticas.descartados++;
+            pthread_mutex_unlock(&g->trava);
+            return 0;
+        }
+
+        // Só aqui a renderização fica bloqueada pelo disco
+        g->estatisticas.bloqueados++;
+        while (g->produzidos - g->consumidos == g->capacidade)
+            pthread_cond_wait(&g->tem_espaco, &g->trava);
+    }
+
+    uint32_t* quadro = g->anel + (g->produzidos % g->capacidade) * g->pixels_por_quadro;
+    pthread_mutex_unlock(&g->trava);
+
+    // A thread de escrita não lê este espaço até `produzidos` avançar
+    size_t bytes_linha = (size_t)g->largura * sizeof(uint32_t);
+    for (int y = 0; y < g->altura; y++)
+        memcpy(quadro + (size_t)y * g->largura, (const char*)pixels + y * pitch, bytes_linha);
+
+    pthread_mutex_lock(&g->trava);
+    g->produzidos++;
+    pthread_cond_signal(&g->tem_quadro);
+    pthread_mutex_unlock(&g->trava);
+
+    return 1;
+}
+
+EstatisticasGravacao gravador_finalizar(Gravador* g) {
+    pthread_mutex_lock(&g->trava);
+    g->encerrar = 1;
+    pthread_cond_signal(&g->tem_quadro);
+    pthread_mutex_unlock(&g->trava);
+
+    pthread_join(g->thread, NULL);
+
+    EstatisticasGravacao estatisticas = g->estatisticas;
+    if (fflush(g->arquivo) != 0)
+        estatisticas.erro_escrita = 1;
+
+    pthread_mutex_destroy(&g->trava);
+    pthread_cond_destroy(&g->tem_quadro);
+    pthread_cond_destroy(&g->tem_espaco);
+    liberar_gravador(g);
+
+    return estatisticas;
+}
@@ -1,12 +1,43 @@
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "autotune.h"
+#include "cancelamento.h"
 #include "log.h"
 #include "matrix_product.h"
+#include "modelo_custo.h"
 #include "utils.h"
 #include "scalar_product.h"
 
+//< Dimensão máxima das matrizes usadas para calibrar o modelo de custo.
+#define TAMANHO_AMOSTRA 64
+
+//< Uma amostra do produto de matrizes para calibrar o modelo de custo.
+typedef struct {
+    visao_matriz_t a;
+    visao_matriz_t b;
+    visao_matriz_t c;
+} AmostraMatrizes;
+
+//< Executa o produto de matrizes sequencial sobre a amostra.
+static void carga_matrizes(void* dados) {
+    AmostraMatrizes* amostra = dados;
+    gemm_seq(1, amostra->a, amostra->b, 0, amostra->c);
+}
+
 int main(int argc, char* argv[]) {
     Args args = validar_argumentos(argc, argv);
+
+    // Ajustar os blocos desta máquina, ou carregar o ajuste feito anteriormente
+    const char* perfil = args.perfil ? args.perfil : caminho_perfil_padrao();
+    if (args.ajustar) {
+        // Permitir interromper o ajuste com `SIGINT` ou pelo prazo, sem salvar o perfil
+        instalar_cancelamento_sinal();
+        definir_prazo_operacao(args.prazo);
+        return ajustar_blocos(perfil) ? 0 : 1;
+    }
+
+    carregar_perfil(perfil);
     
     // Gerar os vetores e verificar a alocação
     matriz_t* a = gerar_matriz(args.size, args.size, -10, 10);
@@ -19,6 +50,33 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Escolher modo e threads pelo modelo de custo, se pedido
+    if (precisa_modelo(&args)) {
+        size_t n = args.size < TAMANHO_AMOSTRA ? args.size : TAMANHO_AMOSTRA;
+        matriz_t* c = criar_matriz_sem_zerar(n, n);
+
+        if (c) {
+            AmostraMatrizes amostra = {
+                .a = visao_submatriz(visao_matriz(a), 0, 0, n, n),
+                .b = visao_submatriz(visao_matriz(b), 0, 0, n, n),
+                .c = visao_matriz(c),
+            };
+
+            ModeloCusto modelo = calibrar_modelo(carga_matrizes, &amostra, (double)n * n * n);
+            double operacoes = (double)args.size * args.size * args.size;
+            resolver_execucao(&args, &modelo, operacoes, modelo.custo_thread);
+            free_matriz(c);
+        } else {
+            // Sem memória para a amostra, manter o comportamento padrão
+            args.mode = (args.mode == AUTO) ? SEQ : args.mode;
+            args.threads = (args.threads == THREADS_AUTO) ? 1 : args.threads;
+        }
+    }
+
+    // Permitir interromper o produto com `SIGINT` ou pelo prazo
+    instalar_cancelamento_sinal();
+    definir_prazo_operacao(args.prazo);
+
     matriz_t* result = NULL;
     double start_time = tempo_segundos();
     
@@ -26,13 +84,26 @@ int main(int argc, char* argv[]) {
         result = produto_matrizes_seq(a, b);
     } else if (args.mode == PAR) {
         result = produto_matrizes_par(a, b, args.threads);
+    } else if (args.mode == PROC) {
+        result = produto_matrizes_proc(a, b, args.threads);
     }
     
     double end_time = tempo_segundos();
     double elapsed = end_time - start_time;
+
+    // Produtos interrompidos ou que falharam não têm resultado
+    if (!result) {
+        if (token_parado(token_operacao()))
+            fprintf(stderr, VERMELHO("ERRO") "\tProduto interrompido após %.3fs\n", elapsed);
+        free_matriz(a);
+        free_matriz(b);
+        return 1;
+    }
     
-    // Gerar saída em formato CSV para automatizar a execução
-    printf("%s,%zu,%d,%.6f\n", args.mode == SEQ ? "seq" : "par", args.size, args.threads, elapsed);
+    // Gerar saída em formato CSV para automatizar a execução. O hash do
+    // resultado permite comparar os modos sem imprimir a matriz.
+    printf("%s,%zu,%d,%.6f,%016" PRIx64 ",%s\n", nome_modo(&args), args.size, args.threads, elapsed,
+        checksum_matriz(result), args.decisao_automatica ? "auto" : "manual");
     
 #ifndef NDEBUG
     // Imprimir a matriz no stderr por debugging
@@ -43,5 +114,6 @@ int main(int argc, char* argv[]) {
 
     free_matriz(a);
     free_matriz(b);
+    free_matriz(result);
     return 0;
 }
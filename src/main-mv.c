@@ -0,0 +1,118 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "cancelamento.h"
+#include "log.h"
+#include "matrix_product.h"
+#include "matrix_vector.h"
+#include "modelo_custo.h"
+#include "utils.h"
+#include "scalar_product.h"
+
+//< Quantidade máxima de linhas de `a` usadas para calibrar o modelo de custo.
+#define LINHAS_AMOSTRA 16
+
+//< Uma amostra do produto matriz-vetor para calibrar o modelo de custo.
+typedef struct {
+    visao_matriz_t a;
+    const int* x;
+    size_t k;
+    long long* y;
+    bool transposta;
+} AmostraMatrizVetor;
+
+//< Executa sobre a amostra o produto matriz-vetor sequencial que será calculado (direto ou transposto).
+static void carga_matriz_vetor(void* dados) {
+    AmostraMatrizVetor* amostra = dados;
+    if (amostra->transposta)
+        gemv_t_seq(amostra->a, amostra->x, amostra->k, amostra->y);
+    else
+        gemv_seq(amostra->a, amostra->x, amostra->k, amostra->y);
+}
+
+int main(int argc, char* argv[]) {
+    Args args = validar_argumentos(argc, argv);
+
+    // O produto matriz-vetor só é paralelizado com threads
+    if (args.mode == PROC) {
+        fprintf(stderr, VERMELHO("ERRO") "\tO modo 'proc' não é suportado pelo produto matriz-vetor\n");
+        return 1;
+    }
+
+    // O ajuste de blocos só existe no produto de matrizes
+    if (args.ajustar || args.perfil) {
+        fprintf(stderr, VERMELHO("ERRO") "\tAs opções '--tune' e '--profile' só são suportadas pelo produto de matrizes\n");
+        return 1;
+    }
+    
+    // Gerar a matriz, os `rhs` vetores e os resultados, e verificar a alocação
+    matriz_t* a = gerar_matriz(args.size, args.size, -10, 10);
+    int* x = gerar_vetor(args.size * args.rhs, -10, 10);
+    long long* y = NULL;
+    if (posix_memalign((void**)&y, TAMANHO_LINHA_CACHE, args.size * args.rhs * sizeof(long long)) != 0)
+        y = NULL;
+    
+    if (!a || !x || !y) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao alocar operandos (n = %lu, rhs = %lu)\n", args.size, args.rhs);
+        free_matriz(a);
+        free(x);
+        free(y);
+        return 1;
+    }
+
+    // Escolher modo e threads pelo modelo de custo, se pedido
+    if (precisa_modelo(&args)) {
+        AmostraMatrizVetor amostra = {
+            .a = visao_submatriz(visao_matriz(a), 0, 0, args.size < LINHAS_AMOSTRA ? args.size : LINHAS_AMOSTRA, args.size),
+            .x = x,
+            .k = args.rhs,
+            .y = y,
+            .transposta = args.transposta,
+        };
+
+        double operacoes_amostra = (double)amostra.a.linhas * args.size * args.rhs;
+        ModeloCusto modelo = calibrar_modelo(carga_matriz_vetor, &amostra, operacoes_amostra);
+        resolver_execucao(&args, &modelo, (double)args.size * args.size * args.rhs, modelo.custo_thread);
+    }
+    
+    // Permitir interromper o produto com `SIGINT` ou pelo prazo
+    instalar_cancelamento_sinal();
+    definir_prazo_operacao(args.prazo);
+
+    int ok = 0;
+    double start_time = tempo_segundos();
+    
+    if (args.mode == SEQ) {
+        ok = args.transposta
+            ? gemv_t_seq(visao_matriz(a), x, args.rhs, y)
+            : gemv_seq(visao_matriz(a), x, args.rhs, y);
+    } else if (args.mode == PAR) {
+        ok = args.transposta
+            ? gemv_t_par(visao_matriz(a), x, args.rhs, y, args.threads)
+            : gemv_par(visao_matriz(a), x, args.rhs, y, args.threads);
+    }
+    
+    double end_time = tempo_segundos();
+    double elapsed = end_time - start_time;
+
+    // Produtos interrompidos ou que falharam não têm resultado
+    if (!ok) {
+        if (token_parado(token_operacao()))
+            fprintf(stderr, VERMELHO("ERRO") "\tProduto interrompido após %.3fs\n", elapsed);
+        free_matriz(a);
+        free(x);
+        free(y);
+        return 1;
+    }
+
+    // Gerar saída em formato CSV para automatizar a execução. O hash dos
+    // `rhs` resultados (sensível à posição de cada elemento) permite comparar os modos.
+    uint64_t hash = hash_fnv1a(HASH_INICIAL, y, args.size * args.rhs * sizeof(long long));
+    printf("%s,%zu,%d,%.6f,%016" PRIx64 ",%s\n", nome_modo(&args), args.size, args.threads, elapsed, hash,
+        args.decisao_automatica ? "auto" : "manual");
+    
+    free_matriz(a);
+    free(x);
+    free(y);
+    return 0;
+}
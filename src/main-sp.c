@@ -1,11 +1,36 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "cancelamento.h"
 #include "log.h"
+#include "modelo_custo.h"
 #include "utils.h"
 #include "scalar_product.h"
 
+//< Quantidade máxima de elementos usados para calibrar o modelo de custo.
+#define TAMANHO_AMOSTRA (1 << 16)
+
+//< Uma amostra do produto escalar para calibrar o modelo de custo.
+typedef struct {
+    const int* v1;
+    const int* v2;
+    size_t n;
+} AmostraEscalar;
+
+//< Executa o produto escalar sequencial sobre a amostra.
+static void carga_escalar(void* dados) {
+    AmostraEscalar* amostra = dados;
+    volatile long long resultado = produto_escalar_seq(amostra->v1, amostra->v2, amostra->n);
+    (void)resultado;
+}
+
 int main(int argc, char* argv[]) {
     Args args = validar_argumentos(argc, argv);
+
+    // O ajuste de blocos só existe no produto de matrizes
+    if (args.ajustar || args.perfil) {
+        fprintf(stderr, VERMELHO("ERRO") "\tAs opções '--tune' e '--profile' só são suportadas pelo produto de matrizes\n");
+        return 1;
+    }
     
     // Gerar os vetores e verificar a alocação
     int* v1 = gerar_vetor(args.size, -100, 100);
@@ -18,6 +43,22 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Escolher modo e threads pelo modelo de custo, se pedido
+    if (precisa_modelo(&args)) {
+        AmostraEscalar amostra = {
+            .v1 = v1,
+            .v2 = v2,
+            .n = args.size < TAMANHO_AMOSTRA ? args.size : TAMANHO_AMOSTRA,
+        };
+
+        ModeloCusto modelo = calibrar_modelo(carga_escalar, &amostra, amostra.n);
+        resolver_execucao(&args, &modelo, args.size, modelo.custo_thread);
+    }
+
+    // Permitir interromper o produto com `SIGINT` ou pelo prazo
+    instalar_cancelamento_sinal();
+    definir_prazo_operacao(args.prazo);
+
     long long result = 0;
     double start_time = tempo_segundos();
     
@@ -25,13 +66,25 @@ int main(int argc, char* argv[]) {
         result = produto_escalar_seq(v1, v2, args.size);
     } else if (args.mode == PAR) {
         result = produto_escalar_par(v1, v2, args.size, args.threads);
+    } else if (args.mode == PROC) {
+        result = produto_escalar_proc(v1, v2, args.size, args.threads);
     }
     
     double end_time = tempo_segundos();
     double elapsed = end_time - start_time;
+
+    // Produtos interrompidos ou que falharam não têm resultado
+    if (token_incompleto(token_operacao())) {
+        if (token_parado(token_operacao()))
+            fprintf(stderr, VERMELHO("ERRO") "\tProduto interrompido após %.3fs\n", elapsed);
+        free(v1);
+        free(v2);
+        return 1;
+    }
     
     // Gerar saída em formato CSV para automatizar a execução
-    printf("%s,%zu,%d,%.6f,%lld\n", args.mode == SEQ ? "seq" : "par", args.size, args.threads, elapsed, result);
+    printf("%s,%zu,%d,%.6f,%lld,%s\n", nome_modo(&args), args.size, args.threads, elapsed, result,
+        args.decisao_automatica ? "auto" : "manual");
     
     free(v1);
     free(v2);
@@ -1,21 +1,104 @@
 #include "matrix_product.h"
+#include "cancelamento.h"
 #include "log.h"
+#include "processos.h"
+#include "utils.h"
 #include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
 
-//< Cria uma matriz com uma dimensão dada.
-matriz_t *criar_matriz(size_t linhas, size_t colunas) {
+//< Tamanho de uma huge page (2 MiB). Alocações menores usam páginas comuns.
+#define TAMANHO_HUGE_PAGE (2u << 20)
+
+/**
+ * Calcula a distância entre linhas para `colunas` elementos. A linha é
+ * arredondada para um múltiplo de 64 bytes e, caso o resultado seja um
+ * múltiplo de 1 KiB (e.g. tamanhos potência de dois), recebe uma linha de
+ * cache extra, evitando que linhas consecutivas disputem os mesmos conjuntos
+ * da cache (4K aliasing) ao percorrer uma coluna.
+ */
+static size_t calcular_ld(size_t colunas) {
+    const size_t por_linha = TAMANHO_LINHA_CACHE / sizeof(int);
+    size_t ld = (colunas + por_linha - 1) / por_linha * por_linha;
+
+    if (ld > 0 && (ld * sizeof(int)) % 1024 == 0)
+        ld += por_linha;
+
+    return ld;
+}
+
+//< Aloca a matriz, zerando os elementos apenas se `zerar` for não-zero.
+static matriz_t *alocar_matriz(size_t linhas, size_t colunas, int zerar) {
     matriz_t *matriz = malloc(sizeof(matriz_t));
-    matriz->dados = calloc(linhas * colunas, sizeof(int));
+    if (!matriz) {
+        perror("Falha ao alocar matriz");
+        return NULL;
+    }
+
     matriz->linhas = linhas;
     matriz->colunas = colunas;
+    matriz->ld = calcular_ld(colunas);
+    matriz->mapeado = 0;
+    matriz->dados = NULL;
+
+    size_t bytes = linhas * matriz->ld * sizeof(int);
+    if (bytes == 0) bytes = TAMANHO_LINHA_CACHE;
+
+    if (bytes >= TAMANHO_HUGE_PAGE) {
+        size_t arredondado = (bytes + TAMANHO_HUGE_PAGE - 1) & ~((size_t)TAMANHO_HUGE_PAGE - 1);
+
+#ifdef MAP_HUGETLB
+        // Tentar huge pages explícitas (falha se não houver páginas reservadas)
+        void *p = mmap(NULL, arredondado, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            // Páginas anônimas já vêm zeradas do kernel
+            matriz->dados = p;
+            matriz->mapeado = arredondado;
+            return matriz;
+        }
+#endif
+
+        // Caso contrário, alinhar a 2 MiB e pedir huge pages transparentes
+        if (posix_memalign((void **)&matriz->dados, TAMANHO_HUGE_PAGE, arredondado) != 0)
+            matriz->dados = NULL;
+#ifdef MADV_HUGEPAGE
+        else
+            madvise(matriz->dados, arredondado, MADV_HUGEPAGE);
+#endif
+    } else if (posix_memalign((void **)&matriz->dados, TAMANHO_LINHA_CACHE, bytes) != 0) {
+        matriz->dados = NULL;
+    }
+
+    if (!matriz->dados) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao alocar matriz %zux%zu\n", linhas, colunas);
+        free(matriz);
+        return NULL;
+    }
+
+    if (zerar)
+        memset(matriz->dados, 0, bytes);
+
     return matriz;
+}
+
+//< Cria uma matriz com uma dimensão dada e todos os elementos zerados.
+matriz_t *criar_matriz(size_t linhas, size_t colunas) {
+    return alocar_matriz(linhas, colunas, 1);
 };
 
+//< Cria uma matriz sem inicializar os elementos, para quando todos serão sobrescritos.
+matriz_t *criar_matriz_sem_zerar(size_t linhas, size_t colunas) {
+    return alocar_matriz(linhas, colunas, 0);
+}
+
 //< Gera uma matriz com uma dimensão dada e valores aleatórios.
 matriz_t *gerar_matriz(size_t linhas, size_t colunas, int min, int max) {
-    matriz_t *matriz = criar_matriz(linhas, colunas);
+    matriz_t *matriz = criar_matriz_sem_zerar(linhas, colunas);
+    if (!matriz)
+        return NULL;
 
     // Gerar valores aleatórios
     for (size_t i = 0; i < linhas; i++) {
@@ -34,7 +117,7 @@ void imprimir_matriz(const matriz_t *m, const char *nome) {
         fprintf(stderr, CIANO("INFO") "\t| ");
         for (size_t j = 0; j < m->colunas; j++) {
             // Pular colunas caso hajam muitas
-            if (j == 15) {
+            if (j == 15 && m->colunas > 20) {
                 fprintf(stderr, " ... ");
                 j = m->colunas - 5;
             }
@@ -46,40 +129,227 @@ void imprimir_matriz(const matriz_t *m, const char *nome) {
 
 //< Libera a memória associada à uma matriz.
 void free_matriz(matriz_t* matriz) {
-    free(matriz->dados);
+    if (!matriz)
+        return;
+
+    if (matriz->mapeado)
+        munmap(matriz->dados, matriz->mapeado);
+    else
+        free(matriz->dados);
+
     free(matriz);
 }
 
+uint64_t checksum_matriz(const matriz_t* matriz) {
+    uint64_t hash = HASH_INICIAL;
+    if (!matriz)
+        return hash;
+
+    for (size_t i = 0; i < matriz->linhas; i++)
+        hash = hash_fnv1a(hash, &MAT_POS(matriz, i, 0), matriz->colunas * sizeof(int));
+
+    return hash;
+}
+
+//< Cria uma visão que cobre a matriz inteira.
+visao_matriz_t visao_matriz(const matriz_t* m) {
+    return (visao_matriz_t) {
+        .dados = m->dados,
+        .linhas = m->linhas,
+        .colunas = m->colunas,
+        .ld = m->ld,
+    };
+}
+
+//< Cria uma visão do bloco `linhas x colunas` de `v` que começa em (`lin`, `col`).
+visao_matriz_t visao_submatriz(visao_matriz_t v, size_t lin, size_t col, size_t linhas, size_t colunas) {
+    // Blocos fora dos limites resultam em uma visão inválida (`dados == NULL`)
+    if (!v.dados || lin + linhas > v.linhas || col + colunas > v.colunas)
+        return (visao_matriz_t) { .dados = NULL };
+
+    return (visao_matriz_t) {
+        .dados = v.dados + lin * v.ld + col,
+        .linhas = linhas,
+        .colunas = colunas,
+        .ld = v.ld,
+    };
+}
+
+//< Os tamanhos de bloco usados pelo kernel, substituíveis pelo perfil do autotuner.
+static config_blocos_t config_blocos = {
+    .bloco_i = 32,
+    .bloco_j = 256,
+    .bloco_k = 128,
+    .desenrolar = 4,
+};
+
+//< Define os tamanhos de bloco usados pelos próximos produtos, retornando `0` (sem alterá-los) caso sejam inválidos.
+int definir_config_blocos(config_blocos_t config) {
+    if (config.bloco_i == 0 || config.bloco_j == 0 || config.bloco_k == 0)
+        return 0;
+
+    // Os acumuladores de um bloco devem caber no vetor da pilha
+    if (config.bloco_j > MAX_ELEMENTOS_BLOCO / config.bloco_i)
+        return 0;
+
+    if (config.desenrolar != 1 && config.desenrolar != 2 && config.desenrolar != 4)
+        config.desenrolar = 1;
+
+    config_blocos = config;
+    return 1;
+}
+
+//< Retorna os tamanhos de bloco usados atualmente.
+config_blocos_t obter_config_blocos(void) {
+    return config_blocos;
+}
+
+/**
+ * Estado de cada thread do produto. Cada instância ocupa linhas de cache
+ * próprias, evitando false sharing entre threads vizinhas.
+ */
 typedef struct {
     //< A matriz à esquerda no produto.
-    const matriz_t* a;
+    ALINHADO_CACHE visao_matriz_t a;
     
     //< A matriz à direita no produto.
-    const matriz_t* b;
+    visao_matriz_t b;
 
     //< Armazena o resultado do produto entre as matrizes.
-    matriz_t* destino;
+    visao_matriz_t destino;
+
+    //< Os escalares de `destino = alfa * a * b + beta * destino`.
+    int alfa;
+    int beta;
     
     //< O índice da linha de `destino` em que a função deve iniciar
     // o cálculo.
     size_t inicio;
 
-    //< A quantidade de linhas para produzir em `destino`.
+    //< O índice (exclusivo) da última linha a produzir em `destino`.
     size_t fim;
+
+    //< Os tamanhos de bloco desta execução.
+    config_blocos_t config;
+
+    //< A thread que calcula este segmento.
+    pthread_t thread;
+
+    //< O token consultado antes de cada bloco de `destino`.
+    TokenParada* parada;
 } ProdMatrizesInfo;
 
-//< Verifica se é possível realizar o produto `a * b`, retornando 1 caso seja.
-static int verificar_produto_matrizes(const matriz_t* a, const matriz_t* b) {
-    return a && b && a->dados && b->dados && a->colunas == b->linhas;
+//< Verifica se é possível realizar `c = a * b`, retornando 1 caso seja.
+static int verificar_gemm(const visao_matriz_t* a, const visao_matriz_t* b, const visao_matriz_t* c) {
+    return a->dados && b->dados && c->dados
+        && a->colunas == b->linhas
+        && c->linhas == a->linhas
+        && c->colunas == b->colunas;
 }
 
-//< Executa o produto entre duas matrizes garantidamente multiplicáveis.
+//< Retorna o menor entre dois `size_t`.
+static inline size_t min_size(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+/**
+ * Acumula em `linha` o produto da linha `pa[kk..fk)` de `a` pelas linhas
+ * `kk..fk` de `b`, nas colunas `[jj, jj + largura)`. As linhas de `b` são
+ * consumidas de `desenrolar` em `desenrolar`, reduzindo as leituras e
+ * escritas de `linha`.
+ */
+static inline void acumular_linha(unsigned int* linha, const int* pa, const visao_matriz_t* b,
+    size_t jj, size_t largura, size_t kk, size_t fk, int desenrolar) {
+    size_t k = kk;
+
+    if (desenrolar == 4) {
+        for (; k + 4 <= fk; k += 4) {
+            unsigned int a0 = pa[k], a1 = pa[k + 1], a2 = pa[k + 2], a3 = pa[k + 3];
+            const int* b0 = &MAT_POS(b, k, jj);
+            const int* b1 = b0 + b->ld;
+            const int* b2 = b1 + b->ld;
+            const int* b3 = b2 + b->ld;
+
+            for (size_t j = 0; j < largura; j++)
+                linha[j] += a0 * b0[j] + a1 * b1[j] + a2 * b2[j] + a3 * b3[j];
+        }
+    }
+
+    if (desenrolar >= 2) {
+        for (; k + 2 <= fk; k += 2) {
+            unsigned int a0 = pa[k], a1 = pa[k + 1];
+            const int* b0 = &MAT_POS(b, k, jj);
+            const int* b1 = b0 + b->ld;
+
+            for (size_t j = 0; j < largura; j++)
+                linha[j] += a0 * b0[j] + a1 * b1[j];
+        }
+    }
+
+    for (; k < fk; k++) {
+        unsigned int a0 = pa[k];
+        const int* b0 = &MAT_POS(b, k, jj);
+
+        for (size_t j = 0; j < largura; j++)
+            linha[j] += a0 * b0[j];
+    }
+}
+
+/**
+ * Executa `destino = alfa * a * b + beta * destino` nas linhas
+ * `[inicio, fim)`. Quando `beta == 0`, `destino` não é lido, podendo
+ * estar não inicializado.
+ *
+ * O produto é feito em blocos `bloco_i x bloco_j` de `destino`, percorrendo
+ * `k` em fatias de `bloco_k` para que as linhas de `b` reutilizadas fiquem
+ * na cache. Cada elemento de `destino` é escrito uma única vez, ao fim do
+ * bloco. A aritmética é feita em `unsigned int`, que dá o mesmo resultado
+ * (módulo 2^32) da soma em `long long` convertida para `int`, mas permite
+ * vetorizar o laço interno.
+ *
+ * Antes de cada bloco o token de parada é consultado; caso pare, as linhas
+ * restantes de `destino` ficam incompletas e o token é marcado como incompleto.
+ */
 void produto_matrizes(ProdMatrizesInfo* info) {
-    for (size_t i = info->inicio; i < info->fim; i++) {
-        for (size_t j = 0; j < info->destino->colunas; j++) {
-            MAT_POS(info->destino, i, j) = 0;
-            for (size_t k = 0; k < info->a->colunas; k++) {
-                MAT_POS(info->destino, i, j) += (long long)(MAT_POS(info->a, i, k)) * MAT_POS(info->b, k, j);
+    const visao_matriz_t* a = &info->a;
+    const visao_matriz_t* b = &info->b;
+    visao_matriz_t* c = &info->destino;
+    const config_blocos_t* cfg = &info->config;
+
+    // Acumuladores de um bloco `bloco_i x bloco_j` de `destino`, na pilha de
+    // cada thread (`definir_config_blocos` garante que o bloco cabe)
+    ALINHADO_CACHE unsigned int acumulador[MAX_ELEMENTOS_BLOCO];
+
+    for (size_t ii = info->inicio; ii < info->fim; ii += cfg->bloco_i) {
+        size_t fi = min_size(ii + cfg->bloco_i, info->fim);
+
+        for (size_t jj = 0; jj < c->colunas; jj += cfg->bloco_j) {
+            if (token_parado(info->parada)) {
+                token_marcar_incompleto(info->parada);
+                return;
+            }
+
+            size_t largura = min_size(cfg->bloco_j, c->colunas - jj);
+            memset(acumulador, 0, (fi - ii) * largura * sizeof(unsigned int));
+
+            for (size_t kk = 0; kk < a->colunas; kk += cfg->bloco_k) {
+                size_t fk = min_size(kk + cfg->bloco_k, a->colunas);
+
+                for (size_t i = ii; i < fi; i++) {
+                    unsigned int* linha = acumulador + (i - ii) * largura;
+                    acumular_linha(linha, &MAT_POS(a, i, 0), b, jj, largura, kk, fk, cfg->desenrolar);
+                }
+            }
+
+            // Escrever o bloco em `destino`
+            for (size_t i = ii; i < fi; i++) {
+                const unsigned int* linha = acumulador + (i - ii) * largura;
+                int* pc = &MAT_POS(c, i, jj);
+
+                for (size_t j = 0; j < largura; j++) {
+                    unsigned int anterior = info->beta ? (unsigned int)info->beta * (unsigned int)pc[j] : 0;
+                    pc[j] = (int)((unsigned int)info->alfa * linha[j] + anterior);
+                }
             }
         }
     }
@@ -91,73 +361,222 @@ void* produto_matrizes_thread(void* arg) {
     return NULL;
 }
 
-//< Calcula sequencialmente o produto `a * b` entre duas matrizes.
-matriz_t *produto_matrizes_seq(const matriz_t* a, const matriz_t* b) {
-    if (!verificar_produto_matrizes(a, b)) {
-        fprintf(stderr, VERMELHO("ERRO") "\tNão é possível multiplicar as matrizes a (%p) e b (%p).", a, b);
-        return NULL;
+//< Calcula sequencialmente `c = alfa * a * b + beta * c`, retornando 1 em caso de sucesso.
+int gemm_seq(int alfa, visao_matriz_t a, visao_matriz_t b, int beta, visao_matriz_t c) {
+    if (!verificar_gemm(&a, &b, &c)) {
+        fprintf(stderr, VERMELHO("ERRO") "\tDimensões incompatíveis no produto (%zux%zu * %zux%zu -> %zux%zu).\n",
+            a.linhas, a.colunas, b.linhas, b.colunas, c.linhas, c.colunas);
+        return 0;
     }
-    
+
+    // Um token próprio, para saber se este produto foi concluído
+    TokenParada parada;
+    token_iniciar(&parada, token_operacao(), 0);
+
     ProdMatrizesInfo info = {
         .a = a,
         .b = b,
-        .destino = criar_matriz(a->linhas, b->colunas),
+        .destino = c,
+        .alfa = alfa,
+        .beta = beta,
         .inicio = 0,
-        .fim = a->linhas,
+        .fim = c.linhas,
+        .config = config_blocos,
+        .parada = &parada,
     };
 
     produto_matrizes(&info);
-    return info.destino;
-};
+    return !token_incompleto(&parada);
+}
 
-//< Calcula paralelamente o produto `a * b` entre duas matrizes, dado o número de threads.
-matriz_t *produto_matrizes_par(const matriz_t* a, const matriz_t* b, int num_threads) {
+//< Calcula paralelamente `c = alfa * a * b + beta * c`, retornando 1 em caso de sucesso.
+int gemm_par(int alfa, visao_matriz_t a, visao_matriz_t b, int beta, visao_matriz_t c, int num_threads) {
     if (num_threads <= 0) return 0;
 
-    if (!verificar_produto_matrizes(a, b)) {
-        fprintf(stderr, VERMELHO("ERRO") "\tNão é possível multiplicar as matrizes a (%p) e b (%p).", a, b);
-        return NULL;
+    if (!verificar_gemm(&a, &b, &c)) {
+        fprintf(stderr, VERMELHO("ERRO") "\tDimensões incompatíveis no produto (%zux%zu * %zux%zu -> %zux%zu).\n",
+            a.linhas, a.colunas, b.linhas, b.colunas, c.linhas, c.colunas);
+        return 0;
     }
     
-    pthread_t* threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
-    ProdMatrizesInfo* thread_data = (ProdMatrizesInfo*)malloc(num_threads * sizeof(ProdMatrizesInfo));
+    ProdMatrizesInfo* thread_data = NULL;
+    if (posix_memalign((void**)&thread_data, TAMANHO_LINHA_CACHE, num_threads * sizeof(ProdMatrizesInfo)) != 0) {
+        perror("Falha ao alocar dados das threads");
+        return 0;
+    }
+    memset(thread_data, 0, num_threads * sizeof(ProdMatrizesInfo));
 
-    matriz_t* destino = criar_matriz(a->linhas, b->colunas);
-    
-    size_t linhas_por_thread = destino->linhas / num_threads;
-    size_t resto = destino->linhas % num_threads;
+    // Um token próprio, para parar as threads já criadas caso alguma falhe
+    TokenParada parada;
+    token_iniciar(&parada, token_operacao(), 0);
 
+    size_t linhas_por_thread = c.linhas / num_threads;
+    size_t resto = c.linhas % num_threads;
+
+    int ok = 1;
+    int criadas = 0;
     size_t inicio_segmento = 0;
     for (int i = 0; i < num_threads; i++) {
         ProdMatrizesInfo* data = &thread_data[i];
 
         data->a = a;
         data->b = b;
-        data->destino = destino;
+        data->destino = c;
+        data->alfa = alfa;
+        data->beta = beta;
         data->inicio = inicio_segmento;
         data->fim = data->inicio + linhas_por_thread + ((size_t)i < resto);
+        data->config = config_blocos;
+        data->parada = &parada;
         
         inicio_segmento += data->fim - data->inicio;
         
-        if (pthread_create(&threads[i], NULL, produto_matrizes_thread, data) != 0) {
-            perror("Falha ao criar thread");
-            
-            // Cancelar todas as threads já iniciadas
-            for (int j = 0; j < i; j++)
-                pthread_cancel(threads[j]);
-
-            free_matriz(destino);
-            free(threads);
-            free(thread_data);
-            return NULL; 
+        int rc = pthread_create(&data->thread, NULL, produto_matrizes_thread, data);
+        if (rc != 0) {
+            fprintf(stderr, VERMELHO("ERRO") "\tFalha ao criar thread: %s\n", strerror(rc));
+            ok = 0;
+            break;
         }
+        criadas++;
     }
-    
-    // Aguardar todas as threads terminarem
-    for (int i = 0; i < num_threads; i++)
-        pthread_join(threads[i], NULL);
-    
-    free(threads);
+
+    // Caso alguma thread não seja criada, pedir que as já iniciadas parem no próximo bloco
+    if (!ok)
+        token_cancelar(&parada);
+
+    // Aguardar as threads antes de liberar o que elas leem
+    for (int i = 0; i < criadas; i++)
+        pthread_join(thread_data[i].thread, NULL);
+
+    // Apenas blocos que de fato ficaram por fazer tornam o produto incompleto
+    if (token_incompleto(&parada))
+        ok = 0;
+
     free(thread_data);
+    return ok;
+}
+
+//< Verifica se é possível realizar o produto `a * b`, retornando 1 caso seja.
+static int verificar_produto_matrizes(const matriz_t* a, const matriz_t* b) {
+    return a && b && a->dados && b->dados && a->colunas == b->linhas;
+}
+
+//< Calcula sequencialmente o produto `a * b` entre duas matrizes.
+matriz_t *produto_matrizes_seq(const matriz_t* a, const matriz_t* b) {
+    if (!verificar_produto_matrizes(a, b)) {
+        fprintf(stderr, VERMELHO("ERRO") "\tNão é possível multiplicar as matrizes a (%p) e b (%p).", a, b);
+        return NULL;
+    }
+
+    // Com `beta = 0` o destino não é lido, então não é preciso zerar
+    matriz_t* destino = criar_matriz_sem_zerar(a->linhas, b->colunas);
+    if (!destino)
+        return NULL;
+
+    if (!gemm_seq(1, visao_matriz(a), visao_matriz(b), 0, visao_matriz(destino))) {
+        free_matriz(destino);
+        return NULL;
+    }
+
     return destino;
 };
+
+//< Calcula paralelamente o produto `a * b` entre duas matrizes, dado o número de threads.
+matriz_t *produto_matrizes_par(const matriz_t* a, const matriz_t* b, int num_threads) {
+    if (num_threads <= 0) return 0;
+
+    if (!verificar_produto_matrizes(a, b)) {
+        fprintf(stderr, VERMELHO("ERRO") "\tNão é possível multiplicar as matrizes a (%p) e b (%p).", a, b);
+        return NULL;
+    }
+
+    // Com `beta = 0` o destino não é lido, então não é preciso zerar
+    matriz_t* destino = criar_matriz_sem_zerar(a->linhas, b->colunas);
+    if (!destino)
+        return NULL;
+
+    if (!gemm_par(1, visao_matriz(a), visao_matriz(b), 0, visao_matriz(destino), num_threads)) {
+        free_matriz(destino);
+        return NULL;
+    }
+
+    return destino;
+};
+
+//< Parâmetros do produto de matrizes entre processos: a disposição de `a`, `b` e `c` na memória compartilhada.
+typedef struct {
+    size_t linhas_a, colunas_a, colunas_b;
+    size_t ld_a, ld_b, ld_c;
+    size_t deslocamento_b, deslocamento_c;
+    config_blocos_t config;
+} ParametrosMatrizesProc;
+
+//< Calcula, em um processo trabalhador, as linhas `[inicio, fim)` de `c = a * b`.
+static long long fragmento_matrizes(void* base, const TarefaProcesso* tarefa, int* ok) {
+    ParametrosMatrizesProc p;
+    memcpy(&p, tarefa->parametros, sizeof(p));
+
+    int* dados = base;
+    visao_matriz_t a = { .dados = dados, .linhas = p.linhas_a, .colunas = p.colunas_a, .ld = p.ld_a };
+    visao_matriz_t b = { .dados = dados + p.deslocamento_b, .linhas = p.colunas_a, .colunas = p.colunas_b, .ld = p.ld_b };
+    visao_matriz_t c = { .dados = dados + p.deslocamento_c, .linhas = p.linhas_a, .colunas = p.colunas_b, .ld = p.ld_c };
+
+    // Usar os mesmos blocos do processo principal (e.g. carregados do perfil)
+    definir_config_blocos(p.config);
+
+    size_t linhas = tarefa->fim - tarefa->inicio;
+    // O trabalhador herda o token (e o prazo) do processo principal
+    *ok = gemm_seq(1,
+        visao_submatriz(a, tarefa->inicio, 0, linhas, a.colunas), b, 0,
+        visao_submatriz(c, tarefa->inicio, 0, linhas, c.colunas));
+    return 0;
+}
+
+//< Calcula o produto `a * b` dividindo as linhas do resultado entre `num_processos` processos.
+matriz_t *produto_matrizes_proc(const matriz_t* a, const matriz_t* b, int num_processos) {
+    if (num_processos <= 0) return NULL;
+
+    if (!verificar_produto_matrizes(a, b)) {
+        fprintf(stderr, VERMELHO("ERRO") "\tNão é possível multiplicar as matrizes a (%p) e b (%p).", a, b);
+        return NULL;
+    }
+
+    matriz_t* destino = criar_matriz_sem_zerar(a->linhas, b->colunas);
+    if (!destino)
+        return NULL;
+
+    ParametrosMatrizesProc p = {
+        .linhas_a = a->linhas,
+        .colunas_a = a->colunas,
+        .colunas_b = b->colunas,
+        .ld_a = a->ld,
+        .ld_b = b->ld,
+        .ld_c = destino->ld,
+        .deslocamento_b = a->linhas * a->ld,
+        .deslocamento_c = a->linhas * a->ld + b->linhas * b->ld,
+        .config = config_blocos,
+    };
+
+    MemoriaCompartilhada memoria;
+    size_t elementos = p.deslocamento_c + destino->linhas * destino->ld;
+    if (!criar_memoria_compartilhada(&memoria, elementos * sizeof(int))) {
+        free_matriz(destino);
+        return NULL;
+    }
+
+    // Copiar os operandos (com o mesmo `ld`) para a memória visível pelos trabalhadores
+    int* dados = memoria.base;
+    int copiados = copiar_operandos(dados, a->dados, p.deslocamento_b * sizeof(int))
+        && copiar_operandos(dados + p.deslocamento_b, b->dados, b->linhas * b->ld * sizeof(int));
+
+    long long ignorado;
+    if (copiados && executar_processos(&memoria, a->linhas, num_processos, &p, sizeof(p), fragmento_matrizes, &ignorado)) {
+        memcpy(destino->dados, dados + p.deslocamento_c, destino->linhas * destino->ld * sizeof(int));
+    } else {
+        free_matriz(destino);
+        destino = NULL;
+    }
+
+    liberar_memoria_compartilhada(&memoria);
+    return destino;
+}
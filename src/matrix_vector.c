@@ -0,0 +1,250 @@
+#include "matrix_vector.h"
+#include "cancelamento.h"
+#include "log.h"
+#include "scalar_product.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//< Quantidade de colunas de `a` processadas por vez, para que o trecho
+// correspondente dos `k` vetores permaneça na cache enquanto `a` é lida.
+#define BLOCO_COLUNAS 4096
+
+//< Quantidade de linhas de `a` processadas entre duas consultas ao token de parada.
+#define LINHAS_PARADA 256
+
+//< Os limites dos segmentos das threads são múltiplos deste valor, para
+// que duas threads não escrevam na mesma linha de cache de `y_0`. Os demais
+// `y_r` começam em `r * total`, então só ficam alinhados quando `total` for
+// múltiplo deste valor; caso contrário, threads vizinhas podem compartilhar
+// a linha de cache de cada limite.
+#define ALINHAMENTO_SEGMENTO (TAMANHO_LINHA_CACHE / sizeof(long long))
+
+//< Estado de cada thread do produto matriz-vetor, em linhas de cache próprias.
+typedef struct {
+    //< A matriz do produto.
+    ALINHADO_CACHE visao_matriz_t a;
+
+    //< Os `k` vetores à direita e os `k` resultados.
+    const int* x;
+    size_t k;
+    long long* y;
+
+    //< O segmento `[inicio, fim)` desta thread: linhas de `a` no produto
+    // direto, colunas de `a` no transposto.
+    size_t inicio;
+    size_t fim;
+
+    //< A thread que calcula este segmento.
+    pthread_t thread;
+
+    //< O token consultado a cada `LINHAS_PARADA` linhas de `a`.
+    TokenParada* parada;
+} ProdMatrizVetorInfo;
+
+//< Um dos kernels (`produto_matriz_vetor` ou `produto_matriz_vetor_t`).
+typedef void (*kernel_mv_f)(ProdMatrizVetorInfo* info);
+
+/**
+ * Calcula as linhas `[inicio, fim)` de `y_r = a * x_r`. Cada elemento é a
+ * soma de produtos escalares (`produto_escalar_seq`) entre um trecho da
+ * linha de `a` e o mesmo trecho de cada `x_r`; cada trecho de `a` é lido
+ * uma única vez para todos os `k` vetores.
+ */
+static void produto_matriz_vetor(ProdMatrizVetorInfo* info) {
+    const visao_matriz_t* a = &info->a;
+    size_t m = a->linhas;
+    size_t n = a->colunas;
+
+    for (size_t r = 0; r < info->k; r++)
+        for (size_t i = info->inicio; i < info->fim; i++)
+            info->y[r * m + i] = 0;
+
+    for (size_t c0 = 0; c0 < n; c0 += BLOCO_COLUNAS) {
+        size_t largura = n - c0 < BLOCO_COLUNAS ? n - c0 : BLOCO_COLUNAS;
+
+        for (size_t i = info->inicio; i < info->fim; i++) {
+            if ((i - info->inicio) % LINHAS_PARADA == 0 && token_parado(info->parada)) {
+                token_marcar_incompleto(info->parada);
+                return;
+            }
+
+            const int* linha = &MAT_POS(a, i, c0);
+
+            for (size_t r = 0; r < info->k; r++)
+                info->y[r * m + i] += produto_escalar_seq(linha, info->x + r * n + c0, largura);
+        }
+    }
+}
+
+/**
+ * Calcula as colunas `[inicio, fim)` de `y_r = aᵀ * x_r`, acumulando cada
+ * linha de `a` escalada por `x_r[i]`. As colunas são processadas em blocos,
+ * para que o trecho de cada `y_r` permaneça na cache durante a passagem
+ * pelas linhas de `a`.
+ */
+static void produto_matriz_vetor_t(ProdMatrizVetorInfo* info) {
+    const visao_matriz_t* a = &info->a;
+    size_t m = a->linhas;
+    size_t n = a->colunas;
+
+    for (size_t r = 0; r < info->k; r++)
+        for (size_t j = info->inicio; j < info->fim; j++)
+            info->y[r * n + j] = 0;
+
+    for (size_t j0 = info->inicio; j0 < info->fim; j0 += BLOCO_COLUNAS) {
+        size_t j1 = info->fim - j0 < BLOCO_COLUNAS ? info->fim : j0 + BLOCO_COLUNAS;
+
+        for (size_t i = 0; i < m; i++) {
+            if (i % LINHAS_PARADA == 0 && token_parado(info->parada)) {
+                token_marcar_incompleto(info->parada);
+                return;
+            }
+
+            const int* linha = &MAT_POS(a, i, 0);
+
+            for (size_t r = 0; r < info->k; r++) {
+                long long xi = info->x[r * m + i];
+                long long* yr = info->y + r * n;
+
+                for (size_t j = j0; j < j1; j++)
+                    yr[j] += xi * linha[j];
+            }
+        }
+    }
+}
+
+//< Um segmento e o kernel que uma thread deve executar sobre ele.
+typedef struct {
+    ProdMatrizVetorInfo* info;
+    kernel_mv_f kernel;
+} TarefaMatrizVetor;
+
+//< Utilitário para executar um kernel com `pthread_create`.
+static void* produto_matriz_vetor_thread(void* arg) {
+    TarefaMatrizVetor* tarefa = arg;
+    tarefa->kernel(tarefa->info);
+    return NULL;
+}
+
+//< Verifica os operandos de um produto matriz-vetor, retornando 1 caso sejam válidos.
+static int verificar_mv(const visao_matriz_t* a, const int* x, const long long* y) {
+    if (a->dados && x && y)
+        return 1;
+
+    fprintf(stderr, VERMELHO("ERRO") "\tOperandos inválidos no produto matriz-vetor.\n");
+    return 0;
+}
+
+/**
+ * Divide `total` linhas/colunas entre `num_threads` threads em segmentos
+ * alinhados a `ALINHAMENTO_SEGMENTO` e executa `kernel` em cada um. A
+ * thread atual calcula o primeiro segmento, assim como os segmentos cujas
+ * threads não puderam ser criadas.
+ */
+static int executar_mv(kernel_mv_f kernel, visao_matriz_t a, const int* x, size_t k, long long* y,
+    size_t total, int num_threads) {
+    if (num_threads <= 0) return 0;
+
+    ProdMatrizVetorInfo* thread_data = NULL;
+    TarefaMatrizVetor* tarefas = malloc(num_threads * sizeof(TarefaMatrizVetor));
+    int* criadas = calloc(num_threads, sizeof(int));
+
+    if (posix_memalign((void**)&thread_data, TAMANHO_LINHA_CACHE, num_threads * sizeof(ProdMatrizVetorInfo)) != 0)
+        thread_data = NULL;
+
+    if (!thread_data || !tarefas || !criadas) {
+        perror("Falha ao alocar dados das threads");
+        free(thread_data);
+        free(tarefas);
+        free(criadas);
+        return 0;
+    }
+
+    // Um token próprio, para saber se todos os segmentos foram concluídos
+    TokenParada parada;
+    token_iniciar(&parada, token_operacao(), 0);
+
+    size_t por_thread = (total + num_threads - 1) / num_threads;
+    por_thread = (por_thread + ALINHAMENTO_SEGMENTO - 1) / ALINHAMENTO_SEGMENTO * ALINHAMENTO_SEGMENTO;
+
+    for (int i = 0; i < num_threads; i++) {
+        ProdMatrizVetorInfo* data = &thread_data[i];
+        size_t inicio = (size_t)i * por_thread;
+
+        data->a = a;
+        data->x = x;
+        data->k = k;
+        data->y = y;
+        data->inicio = inicio < total ? inicio : total;
+        data->fim = inicio + por_thread < total ? inicio + por_thread : total;
+        data->parada = &parada;
+
+        tarefas[i].info = data;
+        tarefas[i].kernel = kernel;
+    }
+
+    for (int i = 1; i < num_threads; i++) {
+        if (thread_data[i].inicio == thread_data[i].fim)
+            continue;
+
+        int rc = pthread_create(&thread_data[i].thread, NULL, produto_matriz_vetor_thread, &tarefas[i]);
+        if (rc == 0)
+            criadas[i] = 1;
+        else
+            fprintf(stderr, VERMELHO("ERRO") "\tFalha ao criar thread: %s\n", strerror(rc));
+    }
+
+    kernel(&thread_data[0]);
+
+    // Aguardar as threads e calcular aqui os segmentos sem thread
+    for (int i = 1; i < num_threads; i++) {
+        if (criadas[i])
+            pthread_join(thread_data[i].thread, NULL);
+        else
+            kernel(&thread_data[i]);
+    }
+
+    free(thread_data);
+    free(tarefas);
+    free(criadas);
+    return !token_incompleto(&parada);
+}
+
+//< Calcula sequencialmente `y_r = a * x_r` para os `k` vetores, retornando 1 em caso de sucesso.
+int gemv_seq(visao_matriz_t a, const int* x, size_t k, long long* y) {
+    if (!verificar_mv(&a, x, y)) return 0;
+
+    TokenParada parada;
+    token_iniciar(&parada, token_operacao(), 0);
+
+    ProdMatrizVetorInfo info = { .a = a, .x = x, .k = k, .y = y, .inicio = 0, .fim = a.linhas, .parada = &parada };
+    produto_matriz_vetor(&info);
+    return !token_incompleto(&parada);
+}
+
+//< Calcula paralelamente `y_r = a * x_r`, dividindo blocos de linhas de `a` entre as threads.
+int gemv_par(visao_matriz_t a, const int* x, size_t k, long long* y, int num_threads) {
+    if (!verificar_mv(&a, x, y)) return 0;
+    return executar_mv(produto_matriz_vetor, a, x, k, y, a.linhas, num_threads);
+}
+
+//< Calcula sequencialmente `y_r = aᵀ * x_r` para os `k` vetores, retornando 1 em caso de sucesso.
+int gemv_t_seq(visao_matriz_t a, const int* x, size_t k, long long* y) {
+    if (!verificar_mv(&a, x, y)) return 0;
+
+    TokenParada parada;
+    token_iniciar(&parada, token_operacao(), 0);
+
+    ProdMatrizVetorInfo info = { .a = a, .x = x, .k = k, .y = y, .inicio = 0, .fim = a.colunas, .parada = &parada };
+    produto_matriz_vetor_t(&info);
+    return !token_incompleto(&parada);
+}
+
+//< Calcula paralelamente `y_r = aᵀ * x_r`, dividindo blocos de colunas de `a` entre as threads.
+int gemv_t_par(visao_matriz_t a, const int* x, size_t k, long long* y, int num_threads) {
+    if (!verificar_mv(&a, x, y)) return 0;
+    return executar_mv(produto_matriz_vetor_t, a, x, k, y, a.colunas, num_threads);
+}
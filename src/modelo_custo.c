@@ -0,0 +1,204 @@
+#include "modelo_custo.h"
+#include "log.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//< Quantas vezes cada medição é repetida; o menor tempo é mantido.
+#define REPETICOES 3
+
+//< Quantidade de threads criadas em cada medição do custo de criação.
+#define THREADS_MEDICAO 4
+
+//< Quantidade de rodadas de barreira na medição do custo de despertar.
+#define RODADAS_BARREIRA 200
+
+//< Uma thread que não faz nada, para medir o custo de criação.
+static void* thread_vazia(void* arg) {
+    return arg;
+}
+
+//< Mede o custo de `pthread_create` + `pthread_join` por thread.
+static double medir_custo_thread(void) {
+    double melhor = -1;
+
+    for (int r = 0; r < REPETICOES; r++) {
+        pthread_t threads[THREADS_MEDICAO];
+        int criadas = 0;
+
+        double inicio = tempo_segundos();
+        for (; criadas < THREADS_MEDICAO; criadas++)
+            if (pthread_create(&threads[criadas], NULL, thread_vazia, NULL) != 0)
+                break;
+        for (int i = 0; i < criadas; i++)
+            pthread_join(threads[i], NULL);
+        double tempo = tempo_segundos() - inicio;
+
+        if (criadas > 0 && (melhor < 0 || tempo / criadas < melhor))
+            melhor = tempo / criadas;
+    }
+
+    return melhor < 0 ? 0 : melhor;
+}
+
+//< Mede o custo de `fork` + `waitpid` por processo, a partir do processo atual
+// (o custo do `fork` cresce com a memória já mapeada, como a dos operandos).
+static double medir_custo_processo(void) {
+    double melhor = -1;
+
+    for (int r = 0; r < REPETICOES; r++) {
+        pid_t processos[THREADS_MEDICAO];
+        int criados = 0;
+
+        double inicio = tempo_segundos();
+        for (; criados < THREADS_MEDICAO; criados++) {
+            processos[criados] = fork();
+            if (processos[criados] < 0)
+                break;
+            if (processos[criados] == 0)
+                _exit(0);
+        }
+        for (int i = 0; i < criados; i++)
+            waitpid(processos[i], NULL, 0);
+        double tempo = tempo_segundos() - inicio;
+
+        if (criados > 0 && (melhor < 0 || tempo / criados < melhor))
+            melhor = tempo / criados;
+    }
+
+    return melhor < 0 ? 0 : melhor;
+}
+
+//< Barreiras usadas na medição do custo de despertar.
+static pthread_barrier_t barreira_inicio;
+static pthread_barrier_t barreira_fim;
+
+//< Imita uma thread de renderização: aguarda o início e sinaliza o fim.
+static void* thread_barreira(void* arg) {
+    for (int i = 0; i < RODADAS_BARREIRA; i++) {
+        pthread_barrier_wait(&barreira_inicio);
+        pthread_barrier_wait(&barreira_fim);
+    }
+    return arg;
+}
+
+//< Mede o custo de uma rodada de sincronização com uma thread já criada.
+static double medir_custo_despertar(void) {
+    pthread_t thread;
+    pthread_barrier_init(&barreira_inicio, NULL, 2);
+    pthread_barrier_init(&barreira_fim, NULL, 2);
+
+    double tempo = 0;
+    if (pthread_create(&thread, NULL, thread_barreira, NULL) == 0) {
+        double inicio = tempo_segundos();
+        for (int i = 0; i < RODADAS_BARREIRA; i++) {
+            pthread_barrier_wait(&barreira_inicio);
+            pthread_barrier_wait(&barreira_fim);
+        }
+        tempo = (tempo_segundos() - inicio) / RODADAS_BARREIRA;
+        pthread_join(thread, NULL);
+    }
+
+    pthread_barrier_destroy(&barreira_inicio);
+    pthread_barrier_destroy(&barreira_fim);
+    return tempo;
+}
+
+ModeloCusto calibrar_modelo(carga_f carga, void* dados, double operacoes) {
+    ModeloCusto modelo = {
+        .custo_thread = medir_custo_thread(),
+        .custo_despertar = medir_custo_despertar(),
+        .tempo_operacao = 0,
+        .nucleos = (int)sysconf(_SC_NPROCESSORS_ONLN),
+    };
+
+    if (modelo.nucleos < 1) modelo.nucleos = 1;
+
+    // A primeira execução também aquece caches e páginas da amostra
+    double melhor = -1;
+    for (int r = 0; r < REPETICOES; r++) {
+        double inicio = tempo_segundos();
+        carga(dados);
+        double tempo = tempo_segundos() - inicio;
+
+        if (melhor < 0 || tempo < melhor) melhor = tempo;
+    }
+
+    if (operacoes > 0)
+        modelo.tempo_operacao = melhor / operacoes;
+
+#ifndef NDEBUG
+    fprintf(stderr, VERDE("DEBUG") "\tModelo: thread %.2eus, despertar %.2eus, operação %.2ens, %d núcleos\n",
+        modelo.custo_thread * 1e6, modelo.custo_despertar * 1e6, modelo.tempo_operacao * 1e9, modelo.nucleos);
+#endif
+
+    return modelo;
+}
+
+double estimar_tempo(const ModeloCusto* modelo, double operacoes, double custo_por_thread, int threads, int paralelo) {
+    double trabalho = operacoes * modelo->tempo_operacao;
+    if (!paralelo)
+        return trabalho;
+
+    // Threads além da quantidade de núcleos não aceleram, apenas custam
+    int efetivas = threads < modelo->nucleos ? threads : modelo->nucleos;
+    return trabalho / efetivas + threads * custo_por_thread;
+}
+
+int precisa_modelo(const Args* args) {
+    return args->mode == AUTO || args->threads == THREADS_AUTO;
+}
+
+void resolver_execucao(Args* args, const ModeloCusto* modelo, double operacoes, double custo_por_thread) {
+    if (!precisa_modelo(args))
+        return;
+
+    // O modo sequencial explícito não usa threads
+    if (args->mode == SEQ) {
+        args->threads = 1;
+        args->decisao_automatica = true;
+        return;
+    }
+
+    // No modo `PROC` cada trabalhador custa um processo, medido apenas quando
+    // necessário. A cópia dos operandos para a memória compartilhada é feita
+    // uma única vez, independente da quantidade de processos, então não muda a escolha.
+    int processos = args->mode == PROC;
+    if (processos)
+        custo_por_thread = medir_custo_processo();
+
+    // Com `--threads auto` a busca vai até a quantidade de núcleos
+    int max_threads = args->threads == THREADS_AUTO ? modelo->nucleos : args->threads;
+    int melhor_threads = max_threads;
+    int melhor_paralelo = 1;
+    double melhor_tempo = -1;
+
+    // No modo automático, considerar também a execução sequencial
+    if (args->mode == AUTO) {
+        melhor_threads = 1;
+        melhor_paralelo = 0;
+        melhor_tempo = estimar_tempo(modelo, operacoes, custo_por_thread, 1, 0);
+    }
+
+    // Sem `--threads auto`, a quantidade de threads é fixa
+    int menor_threads = args->threads == THREADS_AUTO ? 1 : max_threads;
+    for (int t = menor_threads; t <= max_threads; t++) {
+        double tempo = estimar_tempo(modelo, operacoes, custo_por_thread, t, 1);
+        if (melhor_tempo < 0 || tempo < melhor_tempo) {
+            melhor_tempo = tempo;
+            melhor_threads = t;
+            melhor_paralelo = 1;
+        }
+    }
+
+    args->mode = !melhor_paralelo ? SEQ : processos ? PROC : PAR;
+    args->threads = melhor_threads;
+    args->decisao_automatica = true;
+
+#ifndef NDEBUG
+    fprintf(stderr, VERDE("DEBUG") "\tDecisão: %s com %d thread(s), %.3es estimados\n",
+        nome_modo(args), args->threads, melhor_tempo);
+#endif
+}
@@ -0,0 +1,297 @@
+#include "processos.h"
+#include "cancelamento.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//< Intervalo máximo (ms) entre duas consultas ao token de parada enquanto aguarda os trabalhadores.
+#define ESPERA_PARADA_MS 50
+
+//< Quantidade de bytes copiados entre duas consultas ao token de parada.
+#define BLOCO_COPIA (16u << 20)
+
+//< A resposta de um trabalhador para uma tarefa.
+typedef struct {
+    int ok;
+    long long resultado;
+} RespostaProcesso;
+
+//< Um trabalhador em execução, visto pelo processo principal.
+typedef struct {
+    pid_t pid;
+    int socket;
+} Trabalhador;
+
+//< Diferencia as memórias criadas por um mesmo processo.
+static unsigned int contador_memorias = 0;
+
+int criar_memoria_compartilhada(MemoriaCompartilhada* m, size_t tamanho) {
+    snprintf(m->nome, sizeof(m->nome), "/trabalho-so-%ld-%u", (long)getpid(), contador_memorias++);
+    m->tamanho = tamanho > 0 ? tamanho : 1;
+    m->base = NULL;
+
+    int fd = shm_open(m->nome, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao criar memória compartilhada '%s': %s\n", m->nome, strerror(errno));
+        return 0;
+    }
+
+    if (ftruncate(fd, m->tamanho) != 0) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao dimensionar memória compartilhada: %s\n", strerror(errno));
+        close(fd);
+        shm_unlink(m->nome);
+        return 0;
+    }
+
+    void* base = mmap(NULL, m->tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        fprintf(stderr, VERMELHO("ERRO") "\tFalha ao mapear memória compartilhada: %s\n", strerror(errno));
+        shm_unlink(m->nome);
+        return 0;
+    }
+
+    m->base = base;
+    return 1;
+}
+
+void liberar_memoria_compartilhada(MemoriaCompartilhada* m) {
+    if (m->base) {
+        munmap(m->base, m->tamanho);
+        shm_unlink(m->nome);
+        m->base = NULL;
+    }
+}
+
+int copiar_operandos(void* destino, const void* origem, size_t n) {
+    char* d = destino;
+    const char* o = origem;
+
+    for (size_t inicio = 0; inicio < n; inicio += BLOCO_COPIA) {
+        if (token_parado(token_operacao())) {
+            token_marcar_incompleto(token_operacao());
+            return 0;
+        }
+
+        size_t tamanho = n - inicio < BLOCO_COPIA ? n - inicio : BLOCO_COPIA;
+        memcpy(d + inicio, o + inicio, tamanho);
+    }
+
+    return 1;
+}
+
+//< Escreve todos os `n` bytes de `buffer` no socket, retornando `1` em caso de sucesso.
+static int escrever_tudo(int fd, const void* buffer, size_t n) {
+    const char* p = buffer;
+    while (n > 0) {
+        ssize_t escritos = write(fd, p, n);
+        if (escritos < 0 && errno == EINTR) continue;
+        if (escritos <= 0) return 0;
+        p += escritos;
+        n -= escritos;
+    }
+    return 1;
+}
+
+//< Lê exatamente `n` bytes do socket, retornando `0` em erro ou fim da conexão.
+static int ler_tudo(int fd, void* buffer, size_t n) {
+    char* p = buffer;
+    while (n > 0) {
+        ssize_t lidos = read(fd, p, n);
+        if (lidos < 0 && errno == EINTR) continue;
+        if (lidos <= 0) return 0;
+        p += lidos;
+        n -= lidos;
+    }
+    return 1;
+}
+
+/**
+ * Aguarda a resposta de um trabalhador no socket, consultando o token de
+ * parada periodicamente (e no prazo, se houver). Retorna `1` quando há algo
+ * para ler, ou `0` caso a operação tenha parado antes. Uma resposta que já
+ * chegou é aceita mesmo que a operação tenha parado depois.
+ */
+static int aguardar_resposta(int socket, TokenParada* parada) {
+    while (true) {
+        bool parado = token_parado(parada);
+
+        int espera = parado ? 0 : ESPERA_PARADA_MS;
+        double restante = token_restante(parada);
+        if (!parado && restante >= 0 && restante * 1000 < espera)
+            espera = (int)(restante * 1000) + 1;
+
+        struct pollfd p = { .fd = socket, .events = POLLIN };
+        int r = poll(&p, 1, espera);
+
+        // Erros do socket são relatados pela leitura
+        if (r > 0 || (r < 0 && errno != EINTR))
+            return 1;
+        if (parado)
+            return 0;
+    }
+}
+
+/**
+ * Laço principal de um trabalhador: atende tarefas recebidas pelo socket
+ * até o processo principal fechar a conexão. Atualmente cada chamada de
+ * `executar_processos` cria novos trabalhadores e envia uma única tarefa a
+ * cada um, fechando o socket após a resposta.
+ */
+static void servir_tarefas(int socket, fragmento_f fragmento) {
+    TarefaProcesso tarefa;
+
+    while (ler_tudo(socket, &tarefa, sizeof(tarefa))) {
+        RespostaProcesso resposta = { .ok = 0, .resultado = 0 };
+
+        int fd = shm_open(tarefa.memoria, O_RDWR, 0);
+        if (fd >= 0) {
+            void* base = mmap(NULL, tarefa.tamanho_memoria, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+
+            if (base != MAP_FAILED) {
+                resposta.ok = 1;
+                resposta.resultado = fragmento(base, &tarefa, &resposta.ok);
+                munmap(base, tarefa.tamanho_memoria);
+            }
+        }
+
+        if (!escrever_tudo(socket, &resposta, sizeof(resposta)))
+            break;
+    }
+}
+
+/**
+ * Cria um trabalhador conectado por um par de sockets UNIX, retornando `1`
+ * em caso de sucesso. Os `qtd_anteriores` trabalhadores já criados são
+ * passados para que o novo processo feche as pontas herdadas dos seus
+ * sockets; caso contrário, eles nunca veriam o fim da conexão.
+ */
+static int criar_trabalhador(Trabalhador* t, fragmento_f fragmento, const Trabalhador* anteriores, int qtd_anteriores) {
+    int par[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, par) != 0) {
+        perror("Falha ao criar socket");
+        return 0;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Falha ao criar processo");
+        close(par[0]);
+        close(par[1]);
+        return 0;
+    }
+
+    if (pid == 0) {
+        // Trabalhador: atender e sair sem executar `atexit` ou esvaziar o `stdout` herdado
+        close(par[0]);
+        for (int i = 0; i < qtd_anteriores; i++)
+            if (anteriores[i].socket >= 0)
+                close(anteriores[i].socket);
+
+        servir_tarefas(par[1], fragmento);
+        close(par[1]);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(par[1]);
+    t->pid = pid;
+    t->socket = par[0];
+    return 1;
+}
+
+int executar_processos(const MemoriaCompartilhada* memoria, size_t total, int num_processos,
+    const void* parametros, size_t tamanho_parametros, fragmento_f fragmento, long long* soma) {
+    if (num_processos <= 0 || tamanho_parametros > TAMANHO_PARAMETROS) return 0;
+
+    // Não criar trabalhadores para uma operação que já parou
+    if (token_parado(token_operacao())) return 0;
+
+    Trabalhador* trabalhadores = calloc(num_processos, sizeof(Trabalhador));
+    TarefaProcesso* tarefas = calloc(num_processos, sizeof(TarefaProcesso));
+    if (!trabalhadores || !tarefas) {
+        perror("Falha ao alocar trabalhadores");
+        free(trabalhadores);
+        free(tarefas);
+        return 0;
+    }
+
+    // Um trabalhador que morrer não deve encerrar o processo principal ao escrever no socket
+    void (*tratador_anterior)(int) = signal(SIGPIPE, SIG_IGN);
+
+    size_t tamanho_fragmento = total / num_processos;
+    size_t resto = total % num_processos;
+    size_t inicio = 0;
+
+    // Distribuir as tarefas
+    for (int i = 0; i < num_processos; i++) {
+        TarefaProcesso* tarefa = &tarefas[i];
+        snprintf(tarefa->memoria, sizeof(tarefa->memoria), "%s", memoria->nome);
+        tarefa->tamanho_memoria = memoria->tamanho;
+        tarefa->inicio = inicio;
+        tarefa->fim = inicio + tamanho_fragmento + ((size_t)i < resto);
+        memcpy(tarefa->parametros, parametros, tamanho_parametros);
+        inicio = tarefa->fim;
+
+        trabalhadores[i].pid = -1;
+        trabalhadores[i].socket = -1;
+
+        if (criar_trabalhador(&trabalhadores[i], fragmento, trabalhadores, i)
+            && !escrever_tudo(trabalhadores[i].socket, tarefa, sizeof(*tarefa))) {
+            close(trabalhadores[i].socket);
+            trabalhadores[i].socket = -1;
+        }
+    }
+
+    // Reunir os resultados parciais
+    int ok = 1;
+    int parado = 0;
+    *soma = 0;
+    for (int i = 0; i < num_processos; i++) {
+        RespostaProcesso resposta = { .ok = 0, .resultado = 0 };
+
+        if (trabalhadores[i].socket >= 0) {
+            // Se a operação parar, encerrar os trabalhadores que ainda não responderam
+            if (!parado && !aguardar_resposta(trabalhadores[i].socket, token_operacao())) {
+                parado = 1;
+                for (int j = i; j < num_processos; j++)
+                    if (trabalhadores[j].pid > 0)
+                        kill(trabalhadores[j].pid, SIGKILL);
+
+                fprintf(stderr, VERMELHO("ERRO") "\tOperação interrompida; trabalhadores encerrados\n");
+            }
+
+            if (parado || !ler_tudo(trabalhadores[i].socket, &resposta, sizeof(resposta)))
+                resposta.ok = 0;
+            close(trabalhadores[i].socket);
+        } else if (trabalhadores[i].pid < 0) {
+            // Sem processo para este fragmento: calcular localmente
+            resposta.ok = 1;
+            resposta.resultado = fragmento(memoria->base, &tarefas[i], &resposta.ok);
+        }
+
+        if (trabalhadores[i].pid > 0)
+            waitpid(trabalhadores[i].pid, NULL, 0);
+
+        if (!resposta.ok && !parado) {
+            fprintf(stderr, VERMELHO("ERRO") "\tO fragmento %d [%zu, %zu) falhou\n", i, tarefas[i].inicio, tarefas[i].fim);
+        }
+        ok = ok && resposta.ok;
+        *soma += resposta.resultado;
+    }
+
+    signal(SIGPIPE, tratador_anterior);
+    free(trabalhadores);
+    free(tarefas);
+    return ok;
+}
@@ -1,7 +1,15 @@
 #include "scalar_product.h"
+#include "cancelamento.h"
+#include "log.h"
+#include "processos.h"
+#include "utils.h"
 #include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+//< Quantidade de elementos processados entre duas consultas ao token de parada.
+#define BLOCO_PARADA (1 << 16)
 
 //< Gera um vetor de tamanho `n` com números aleatórios entre `min` e `max`.
 int* gerar_vetor(size_t n, int min, int max) {
@@ -23,9 +31,14 @@ int* gerar_vetor(size_t n, int min, int max) {
     return v;
 }
 
+/**
+ * Estado de cada thread do produto escalar. Cada instância ocupa linhas de
+ * cache próprias, para que a escrita de `resultado` por uma thread não
+ * invalide a linha lida pelas vizinhas (false sharing).
+ */
 typedef struct {
     //< O primeiro vetor do produto escalar.
-    const int* v1;
+    ALINHADO_CACHE const int* v1;
     
     //< O segundo vetor do produto escalar.
     const int* v2;
@@ -37,19 +50,70 @@ typedef struct {
     //< Armazena o resultado do produto escalar após executar
     // a função `produto_escalar(...);`
     long long resultado;
+
+    //< A thread que calcula este segmento.
+    pthread_t thread;
+
+    //< O token consultado entre os blocos do segmento.
+    TokenParada* parada;
+
+    //< A posição deste segmento e o vetor com todos os segmentos, usados
+    // na redução em árvore.
+    int indice;
+    int total;
+    void* segmentos;
 } ProdEscalarInfo;
 
-//< Executa o produto escalar entre dois vetores quaisquer.
+/**
+ * Executa o produto escalar entre dois vetores quaisquer, em blocos de
+ * `BLOCO_PARADA` elementos. Entre os blocos o token de parada é consultado;
+ * caso pare, o resultado fica parcial e o token é marcado como incompleto.
+ */
 void produto_escalar(ProdEscalarInfo* info) {
-    info->resultado = 0;
-    for (size_t i = 0; i < info->tamanho; i++) {
-        info->resultado += (long long)(info->v1[i]) * info->v2[i];
+    // Acumular em um registrador e escrever o resultado uma única vez
+    const int* v1 = info->v1;
+    const int* v2 = info->v2;
+    long long soma = 0;
+
+    for (size_t inicio = 0; inicio < info->tamanho; inicio += BLOCO_PARADA) {
+        if (inicio > 0 && token_parado(info->parada)) {
+            token_marcar_incompleto(info->parada);
+            break;
+        }
+
+        size_t fim = info->tamanho - inicio < BLOCO_PARADA ? info->tamanho : inicio + BLOCO_PARADA;
+        for (size_t i = inicio; i < fim; i++) {
+            soma += (long long)(v1[i]) * v2[i];
+        }
     }
+
+    info->resultado = soma;
 }
 
-//< Utilitário para executar `produto_escalar` com `pthread_create`.
+/**
+ * Calcula o segmento de `info` e soma os resultados da sua subárvore: o
+ * segmento `i` aguarda e acumula os segmentos `i + 1`, `i + 2`, `i + 4`, ...
+ * enquanto o bit correspondente de `i` for zero. Assim o segmento 0 termina
+ * com a soma total após `log2(total)` passos, e cada thread é aguardada
+ * (`pthread_join`) exatamente uma vez.
+ */
+static void produto_escalar_reduzir(ProdEscalarInfo* info) {
+    ProdEscalarInfo* segmentos = info->segmentos;
+    produto_escalar(info);
+
+    long long soma = info->resultado;
+    for (int passo = 1; (info->indice & passo) == 0 && info->indice + passo < info->total; passo <<= 1) {
+        ProdEscalarInfo* filho = &segmentos[info->indice + passo];
+        pthread_join(filho->thread, NULL);
+        soma += filho->resultado;
+    }
+
+    info->resultado = soma;
+}
+
+//< Utilitário para executar `produto_escalar_reduzir` com `pthread_create`.
 void* produto_escalar_thread(void* arg) {
-    produto_escalar((ProdEscalarInfo*) arg);
+    produto_escalar_reduzir((ProdEscalarInfo*) arg);
     return NULL;
 }
 
@@ -59,55 +123,129 @@ long long produto_escalar_seq(const int* v1, const int* v2, size_t n) {
         .v1 = v1,
         .v2 = v2,
         .tamanho = n,
-        .resultado = 0
+        .resultado = 0,
+        .parada = token_operacao(),
     };
 
     produto_escalar(&info);
     return info.resultado;
 }
 
+//< Retorna o segmento que aguarda o segmento `i` na redução em árvore (`i` sem o bit menos significativo).
+static int segmento_pai(int i) {
+    return i & (i - 1);
+}
+
 //< Calcula paralelamente o produto escalar `v1 * v2` entre dois vetores, dado um número de threads.
 long long produto_escalar_par(const int* v1, const int* v2, size_t n, int num_threads) {
     if (num_threads <= 0) return 0;
     
-    pthread_t* threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
-    ProdEscalarInfo* thread_data = (ProdEscalarInfo*)malloc(num_threads * sizeof(ProdEscalarInfo));
+    ProdEscalarInfo* thread_data = NULL;
+    if (posix_memalign((void**)&thread_data, TAMANHO_LINHA_CACHE, num_threads * sizeof(ProdEscalarInfo)) != 0) {
+        perror("Falha ao alocar dados das threads");
+        token_marcar_incompleto(token_operacao());
+        return 0;
+    }
     
     size_t tamanho_segmento = n / num_threads;
     size_t resto = n % num_threads;
     
     size_t inicio_segmento = 0;
-    
     for (int i = 0; i < num_threads; i++) {
         ProdEscalarInfo* data = &thread_data[i];
 
         data->v1 = v1 + inicio_segmento;
         data->v2 = v2 + inicio_segmento;
         data->tamanho = tamanho_segmento + ((size_t)i < resto);
+        data->resultado = 0;
+        data->indice = i;
+        data->total = num_threads;
+        data->segmentos = thread_data;
+        data->parada = token_operacao();
         
         inicio_segmento += data->tamanho;
-        
-        if (pthread_create(&threads[i], NULL, produto_escalar_thread, data) != 0) {
-            perror("Falha ao criar thread");
-            
-            // Cancelar todas as threads já iniciadas
-            for (int j = 0; j < i; j++)
-                pthread_cancel(threads[j]);
-
-            free(threads);
-            free(thread_data);
-            return 0; 
+    }
+
+    /**
+     * Criar as threads em ordem decrescente, para que cada segmento já
+     * tenha sua `pthread_t` definida quando o pai for aguardá-lo. O
+     * segmento 0 (raiz da redução) é calculado pela thread atual.
+     */
+    int primeira_criada = num_threads;
+    for (int i = num_threads - 1; i > 0; i--) {
+        int rc = pthread_create(&thread_data[i].thread, NULL, produto_escalar_thread, &thread_data[i]);
+        if (rc != 0) {
+            fprintf(stderr, VERMELHO("ERRO") "\tFalha ao criar thread: %s\n", strerror(rc));
+            break;
         }
+        primeira_criada = i;
     }
-    
-    // Aguardar todas as threads terminarem e somar seus resultados
+
     long long soma_total = 0;
-    for (int i = 0; i < num_threads; i++) {
-        pthread_join(threads[i], NULL);
-        soma_total += thread_data[i].resultado;
+    if (primeira_criada == 1) {
+        produto_escalar_reduzir(&thread_data[0]);
+        soma_total = thread_data[0].resultado;
+    } else {
+        // Calcular aqui os segmentos sem thread e aguardar as subárvores
+        // já criadas cujo pai ficou sem thread
+        for (int i = 0; i < primeira_criada; i++) {
+            produto_escalar(&thread_data[i]);
+            soma_total += thread_data[i].resultado;
+        }
+        for (int i = primeira_criada; i < num_threads; i++) {
+            if (segmento_pai(i) < primeira_criada) {
+                pthread_join(thread_data[i].thread, NULL);
+                soma_total += thread_data[i].resultado;
+            }
+        }
     }
     
-    free(threads);
     free(thread_data);
     return soma_total;
 }
+
+//< Parâmetros do produto escalar entre processos: `v1` e `v2` ficam em sequência na memória compartilhada.
+typedef struct {
+    size_t n;
+} ParametrosEscalarProc;
+
+//< Calcula, em um processo trabalhador, o produto escalar do fragmento recebido.
+static long long fragmento_escalar(void* base, const TarefaProcesso* tarefa, int* ok) {
+    ParametrosEscalarProc parametros;
+    memcpy(&parametros, tarefa->parametros, sizeof(parametros));
+
+    const int* v1 = base;
+    const int* v2 = v1 + parametros.n;
+
+    // O trabalhador herda o token (e o prazo) do processo principal
+    long long resultado = produto_escalar_seq(v1 + tarefa->inicio, v2 + tarefa->inicio, tarefa->fim - tarefa->inicio);
+    if (token_incompleto(token_operacao()))
+        *ok = 0;
+    return resultado;
+}
+
+//< Calcula o produto escalar `v1 * v2` dividido entre `num_processos` processos.
+long long produto_escalar_proc(const int* v1, const int* v2, size_t n, int num_processos) {
+    if (num_processos <= 0) return 0;
+
+    MemoriaCompartilhada memoria;
+    if (!criar_memoria_compartilhada(&memoria, 2 * n * sizeof(int))) {
+        token_marcar_incompleto(token_operacao());
+        return 0;
+    }
+
+    // Copiar os operandos para a memória visível pelos trabalhadores
+    int copiados = copiar_operandos(memoria.base, v1, n * sizeof(int))
+        && copiar_operandos((int*)memoria.base + n, v2, n * sizeof(int));
+
+    ParametrosEscalarProc parametros = { .n = n };
+    long long soma = 0;
+    if (!copiados
+        || !executar_processos(&memoria, n, num_processos, &parametros, sizeof(parametros), fragmento_escalar, &soma)) {
+        token_marcar_incompleto(token_operacao());
+        soma = 0;
+    }
+
+    liberar_memoria_compartilhada(&memoria);
+    return soma;
+}
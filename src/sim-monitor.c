@@ -0,0 +1,144 @@
+#include "frame_metrics.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//< Intervalo padrão entre as leituras (s).
+#define INTERVALO_PADRAO 1.0
+
+//< Quantidade de registros copiados do anel por chamada a `metricas_ler`.
+#define REGISTROS_POR_LEITURA 1024
+
+//< Tempo máximo aguardando a simulação criar as métricas (s).
+#define ESPERA_ABERTURA 10
+
+//< Os percentis impressos (as colunas `p50_ms`, `p99_ms` e `p999_ms`).
+static const double PERCENTIS[] = { 0.5, 0.99, 0.999 };
+
+//< Imprime uma mensagem padrão de uso do programa.
+static void imprimir_uso(const char* prog_name) {
+    fprintf(stderr, "Uso: %s <nome> --interval [S] --threads\n", prog_name);
+}
+
+//< Dorme por `segundos`.
+static void dormir(double segundos) {
+    struct timespec ts = {
+        .tv_sec = (time_t)segundos,
+        .tv_nsec = (long)((segundos - (time_t)segundos) * 1e9),
+    };
+    nanosleep(&ts, NULL);
+}
+
+//< Imprime uma linha CSV com os percentis (ms) de um histograma.
+static void imprimir_linha(const char* janela, const char* fase, const HistogramaLatencia* h) {
+    printf("%s,%s,%llu", janela, fase, (unsigned long long)h->total);
+    for (size_t i = 0; i < sizeof(PERCENTIS) / sizeof(PERCENTIS[0]); i++)
+        printf(",%.3f", histograma_percentil(h, PERCENTIS[i]) / 1e6);
+    printf(",%.3f\n", h->maximo / 1e6);
+}
+
+//< Imprime os percentis de todas as fases (e, se pedido, de cada thread).
+static void imprimir_histogramas(const char* janela, const HistogramaLatencia* fases, const HistogramaLatencia* render,
+    uint32_t threads, int por_thread) {
+    for (int f = 0; f < FASES_QUADRO; f++)
+        imprimir_linha(janela, nome_fase(f), &fases[f]);
+
+    for (uint32_t t = 0; por_thread && t < threads; t++) {
+        char nome[32];
+        snprintf(nome, sizeof(nome), "render[%u]", t);
+        imprimir_linha(janela, nome, &render[t]);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* nome = NULL;
+    double intervalo = INTERVALO_PADRAO;
+    int por_thread = 0;
+
+    // Analisar argumentos da linha de comando
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            intervalo = atof(argv[++i]);
+            intervalo = intervalo > 0 ? intervalo : INTERVALO_PADRAO;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            por_thread = 1;
+        } else if (!nome && argv[i][0] != '-') {
+            nome = argv[i];
+        } else {
+            imprimir_uso(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!nome) {
+        imprimir_uso(argv[0]);
+        return 1;
+    }
+
+    // Aguardar a simulação publicar as métricas
+    const MetricasCompartilhadas* m = NULL;
+    for (double esperado = 0; !(m = metricas_abrir(nome)) && esperado < ESPERA_ABERTURA; esperado += 0.1)
+        dormir(0.1);
+
+    if (!m) {
+        fprintf(stderr, VERMELHO("ERRO") "\tNão foi possível abrir as métricas '%s'\n", nome);
+        return 1;
+    }
+
+    // Histogramas da janela atual, preenchidos com os registros do anel
+    HistogramaLatencia* fases = calloc(FASES_QUADRO, sizeof(HistogramaLatencia));
+    HistogramaLatencia* render = calloc(MAX_THREADS_METRICAS, sizeof(HistogramaLatencia));
+    RegistroQuadro* registros = malloc(REGISTROS_POR_LEITURA * sizeof(RegistroQuadro));
+    if (!fases || !render || !registros) {
+        perror("Falha ao alocar histogramas");
+        metricas_fechar(m);
+        free(fases);
+        free(render);
+        free(registros);
+        return 1;
+    }
+
+    // Acompanhar apenas os quadros a partir de agora
+    uint64_t proximo = atomic_load_explicit(&m->escritos, memory_order_acquire);
+    uint64_t perdidos = 0;
+    unsigned long janela = 0;
+
+    printf("janela,fase,quadros,p50_ms,p99_ms,p999_ms,max_ms\n");
+
+    while (atomic_load_explicit(&m->ativo, memory_order_acquire)) {
+        dormir(intervalo);
+
+        memset(fases, 0, FASES_QUADRO * sizeof(HistogramaLatencia));
+        memset(render, 0, MAX_THREADS_METRICAS * sizeof(HistogramaLatencia));
+
+        size_t lidos;
+        while ((lidos = metricas_ler(m, &proximo, registros, REGISTROS_POR_LEITURA, &perdidos)) > 0) {
+            for (size_t i = 0; i < lidos; i++) {
+                for (int f = 0; f < FASES_QUADRO; f++)
+                    histograma_registrar(&fases[f], registros[i].fases[f]);
+                for (uint32_t t = 0; t < m->threads; t++)
+                    histograma_registrar(&render[t], registros[i].render[t]);
+            }
+        }
+
+        char rotulo[32];
+        snprintf(rotulo, sizeof(rotulo), "%lu", janela++);
+        imprimir_histogramas(rotulo, fases, render, m->threads, por_thread);
+        fflush(stdout);
+    }
+
+    // Ao fim da simulação, imprimir os histogramas acumulados desde o início
+    imprimir_histogramas("total", m->fases, m->render, m->threads, por_thread);
+
+    if (perdidos > 0)
+        fprintf(stderr, AMARELO("AVISO") "\t%llu registros sobrescritos antes da leitura; reduza --interval\n",
+            (unsigned long long)perdidos);
+
+    metricas_fechar(m);
+    free(fases);
+    free(render);
+    free(registros);
+    return 0;
+}
@@ -7,9 +7,14 @@
 #include "SDL3/SDL_surface.h"
 #include "SDL3/SDL_timer.h"
 #include "SDL3/SDL_video.h"
+#include "cancelamento.h"
+#include "frame_metrics.h"
+#include "gravador.h"
+#include "modelo_custo.h"
 #include "pthread.h"
 #include "utils.h"
 #include <errno.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,6 +32,14 @@ enum {
     RAIO_MAX = 30,
     //< Velocidade inicial máxima dos círculos (px)
     VEL_MAX = 5,
+    //< Taxa de quadros nominal registrada nas gravações
+    FPS_GRAVACAO = 60,
+    //< Memória máxima reservada ao anel de quadros da gravação (MiB)
+    MEMORIA_GRAVACAO = 256,
+    //< Quantidade máxima de quadros no anel de gravação
+    QUADROS_GRAVACAO = 32,
+    //< Quantidade de linhas renderizadas para calibrar o modelo de custo
+    LINHAS_AMOSTRA = 16,
 };
 
 typedef struct {
@@ -36,12 +49,16 @@ typedef struct {
     Uint32 c;
 } Circulo;
 
+//< Estado de cada thread de renderização, em linhas de cache próprias.
 typedef struct {
     //< A thread que utiliza esta struct.
-    pthread_t thread;
+    ALINHADO_CACHE pthread_t thread;
 
     //< O retângulo que esta thread irá renderizar.
     SDL_Rect rect;
+
+    //< O tempo (ns) que esta thread levou para renderizar o último quadro.
+    uint64_t tempo_render;
 } ThreadInfo;
 
 //< Variáveis utilizadas para gerenciar a janela e renderização.
@@ -57,6 +74,15 @@ static size_t n_circulos;
 static Uint64 fpsPerf = 0;
 static int frames = 0;
 
+//< O hash do primeiro quadro, que depende apenas da seed e não do modo.
+static uint64_t hashPrimeiroQuadro = HASH_INICIAL;
+
+//< O gravador de quadros, caso `--record` tenha sido passado.
+static Gravador* gravador = NULL;
+
+//< As métricas por quadro, caso `--metrics` tenha sido passado.
+static MetricasQuadro* metricas = NULL;
+
 //< Inicializa os círculos com valores aleatórios.
 int inicializar_circulos(size_t qtd) {
     // Alocar os círculos
@@ -98,6 +124,61 @@ int circulos_colidem(const Circulo *a, const Circulo *b) {
     return ((dcx * dcx) + (dcy * dcy) < (dr * dr));
 }
 
+/**
+ * Resolve a colisão de `a`, que se move de `(ox, oy)` para `(dx, dy)`, com
+ * `b`: recua `a` ao longo do movimento até tocar `b` (atualizando o destino)
+ * e troca a componente normal das velocidades.
+ */
+static void resolver_colisao(Circulo *a, Circulo *b, double ox, double oy, double *dx, double *dy) {
+    /*
+        Se A se mover para D(dx, dy), os círculos A e B colidem.
+        Para evitar essa colisão, calcula-se o parâmetro `p1`, usado para
+        calcular uma nova posição D', dado que...
+            D' = A + p (D - A)
+        tal que...
+            || D' - B || = rA + rB
+    */
+    double ux = *dx - ox;
+    double uy = *dy - oy;
+    double vx = b->x - ox;
+    double vy = b->y - oy;
+    double t = vx * ux + vy * uy;
+    double R2 = SDL_pow(a->r + b->r, 2);
+    double h2 = (vx * vx + vy * vy) - (t * t);
+
+    if (h2 > R2) h2 = R2;
+    double p = t - SDL_sqrt(R2 - h2);
+
+    a->x = *dx = ox + p * ux;
+    a->y = *dy = oy + p * uy;
+
+
+    double ma = SDL_sqrt(a->r);
+    double mb = SDL_sqrt(b->r);
+
+    //< Igual a A - B
+    double xAdB = a->x - b->x, yAdB = a->y - b->y;
+
+    //< Igual a ||A - B||
+    double lAdB = SDL_sqrt((xAdB * xAdB) + (yAdB * yAdB));
+
+    //< Igual a (A - B) / ||A - B||
+    double xNhat = xAdB / lAdB, yNhat = yAdB / lAdB;
+
+    //< Igual a Va - Vb
+    double xVadVb = a->vx - b->vx, yVadVb = a->vy - b->vy;
+
+    //< Igual a (Va - Vb) * nhat
+    double Vn = (xVadVb * xNhat) + (yVadVb * yNhat);
+    double j = (- (1.0 + SDL_randf()) * Vn) / ( (1./ma) + (1./mb) );
+
+    //< Igual a Vn * nhat
+    a->vx -= xNhat * Vn;
+    a->vy -= yNhat * Vn;
+    b->vx += xNhat * Vn;
+    b->vy += yNhat * Vn;
+}
+
 //< Retorna `1` se for possível realizar o movimento de `c` para `(xd, yd)`
 int tentar_movimento(Circulo *a, double dx, double dy) {
     double ox = a->x;
@@ -116,61 +197,131 @@ int tentar_movimento(Circulo *a, double dx, double dy) {
 
             if (circulos_colidem(a, b)) {
                 colidiu = true;
+                resolver_colisao(a, b, ox, oy, &dx, &dy);
+            }
+        }
+    }
+
+    return 1;
+}
+
+//< Uma entrada da ordem de varredura: a borda esquerda (`x - r`) de um círculo.
+typedef struct {
+    double chave;
+    size_t indice;
+} EntradaVarredura;
+
+//< Os círculos ordenados pela borda esquerda, e a posição de cada um nessa ordem.
+static EntradaVarredura *ordemVarredura = NULL;
+static size_t *posicaoVarredura = NULL;
+
+//< Compara duas entradas da ordem de varredura, para o `qsort`.
+static int comparar_entradas(const void *a, const void *b) {
+    double ca = ((const EntradaVarredura *)a)->chave;
+    double cb = ((const EntradaVarredura *)b)->chave;
+    return (ca > cb) - (ca < cb);
+}
+
+//< Ordena os círculos pela borda esquerda para a fase ampla por varredura.
+int inicializar_varredura(void) {
+    ordemVarredura = malloc(n_circulos * sizeof(EntradaVarredura));
+    posicaoVarredura = malloc(n_circulos * sizeof(size_t));
+
+    if (!ordemVarredura || !posicaoVarredura) {
+        SDL_Log("Não foi possível alocar a ordem de varredura.");
+        return 0;
+    }
+
+    for (size_t i = 0; i < n_circulos; i++)
+        ordemVarredura[i] = (EntradaVarredura) { .chave = circulos[i].x - circulos[i].r, .indice = i };
+
+    // Apenas a primeira ordenação parte de posições arbitrárias
+    qsort(ordemVarredura, n_circulos, sizeof(EntradaVarredura), comparar_entradas);
+    for (size_t p = 0; p < n_circulos; p++)
+        posicaoVarredura[ordemVarredura[p].indice] = p;
+
+    return 1;
+}
+
+/**
+ * Recoloca o círculo `indice` na ordem de varredura após o seu movimento,
+ * por inserção. Como cada círculo se move no máximo `VEL_MAX` píxeis por
+ * quadro, ele se desloca poucas posições e o custo é quase constante.
+ */
+static void reposicionar_varredura(size_t indice) {
+    EntradaVarredura e = { .chave = circulos[indice].x - circulos[indice].r, .indice = indice };
+    size_t p = posicaoVarredura[indice];
+
+    while (p > 0 && ordemVarredura[p - 1].chave > e.chave) {
+        ordemVarredura[p] = ordemVarredura[p - 1];
+        posicaoVarredura[ordemVarredura[p].indice] = p;
+        p--;
+    }
+
+    while (p + 1 < n_circulos && ordemVarredura[p + 1].chave < e.chave) {
+        ordemVarredura[p] = ordemVarredura[p + 1];
+        posicaoVarredura[ordemVarredura[p].indice] = p;
+        p++;
+    }
+
+    ordemVarredura[p] = e;
+    posicaoVarredura[indice] = p;
+}
+
+//< Retorna a primeira posição da ordem de varredura com borda esquerda `>= chave`.
+static size_t buscar_varredura(double chave) {
+    size_t inicio = 0, fim = n_circulos;
+    while (inicio < fim) {
+        size_t meio = inicio + (fim - inicio) / 2;
+        if (ordemVarredura[meio].chave < chave)
+            inicio = meio + 1;
+        else
+            fim = meio;
+    }
+    return inicio;
+}
+
+/**
+ * Igual a `tentar_movimento`, mas testa apenas os círculos cujo intervalo
+ * `[x - r, x + r]` sobrepõe o de `a`. Como `r <= RAIO_MAX`, esses círculos
+ * têm borda esquerda em `[ax - ra - 2 * RAIO_MAX, ax + ra)`.
+ */
+int tentar_movimento_varredura(Circulo *a, double dx, double dy) {
+    double ox = a->x;
+    double oy = a->y;
+    a->x = dx;
+    a->y = dy;
+
+    bool colidiu = true;
+    size_t iter = 0;
+    while (colidiu && iter++ < 4) {
+        colidiu = false;
 
-                /*
-                    Se A se mover para D(dx, dy), os círculos A e B colidem.
-                    Para evitar essa colisão, calcula-se o parâmetro `p1`, usado para
-                    calcular uma nova posição D', dado que...
-                        D' = A + p (D - A)
-                    tal que...
-                        || D' - B || = rA + rB
-                */
-                double ux = dx - ox;
-                double uy = dy - oy;
-                double vx = b->x - ox;
-                double vy = b->y - oy;
-                double t = vx * ux + vy * uy;
-                double R2 = SDL_pow(a->r + b->r, 2);
-                double h2 = (vx * vx + vy * vy) - (t * t);
-                
-                if (h2 > R2) h2 = R2;
-                double p = t - SDL_sqrt(R2 - h2);
-
-                a->x = dx = ox + p * ux;
-                a->y = dy = oy + p * uy;
-
-
-                double ma = SDL_sqrt(a->r);
-                double mb = SDL_sqrt(b->r);
-
-                //< Igual a A - B
-                double xAdB = a->x - b->x, yAdB = a->y - b->y;
-
-                //< Igual a ||A - B||
-                double lAdB = SDL_sqrt((xAdB * xAdB) + (yAdB * yAdB));
-                
-                //< Igual a (A - B) / ||A - B||
-                double xNhat = xAdB / lAdB, yNhat = yAdB / lAdB;
-                
-                //< Igual a Va - Vb
-                double xVadVb = a->vx - b->vx, yVadVb = a->vy - b->vy;
-
-                //< Igual a (Va - Vb) * nhat
-                double Vn = (xVadVb * xNhat) + (yVadVb * yNhat);
-                double j = (- (1.0 + SDL_randf()) * Vn) / ( (1./ma) + (1./mb) );
-                
-                //< Igual a Vn * nhat
-                a->vx -= xNhat * Vn;
-                a->vy -= yNhat * Vn;
-                b->vx += xNhat * Vn;
-                b->vy += yNhat * Vn;
+        // O fim da janela acompanha `a` caso uma colisão o recue durante a varredura
+        size_t p = buscar_varredura(a->x - a->r - 2 * RAIO_MAX);
+        for (; p < n_circulos && ordemVarredura[p].chave < a->x + a->r; p++) {
+            Circulo *b = circulos + ordemVarredura[p].indice;
+
+            if (a == b) continue;
+
+            if (circulos_colidem(a, b)) {
+                colidiu = true;
+                resolver_colisao(a, b, ox, oy, &dx, &dy);
             }
         }
     }
 
+    // Apenas `a` mudou de posição
+    reposicionar_varredura(a - circulos);
     return 1;
 }
 
+//< Usado para se referir genericamente à `tentar_movimento` ou `tentar_movimento_varredura`
+typedef int (*movimento_f)(Circulo *a, double dx, double dy);
+
+//< A fase ampla escolhida por `--broadphase`.
+static movimento_f movimento = tentar_movimento;
+
 //< Move todos os círculos e previne colisões entre as bordas.
 void mover_circulos() {
     for (int i = 0; i < n_circulos; i++) {
@@ -186,7 +337,7 @@ void mover_circulos() {
         if (dx >= canvas->w - c->r) { dx = canvas->w - c->r; flipx = 1; }
         if (dy >= canvas->h - c->r) { dy = canvas->h - c->r; flipy = 1; }
 
-        tentar_movimento(c, dx, dy);
+        movimento(c, dx, dy);
 
         if (flipx) c->vx = -c->vx;
         if (flipy) c->vy = -c->vy;
@@ -231,15 +382,44 @@ void renderizar(const SDL_Rect* rect) {
 static pthread_barrier_t rendInicio;
 static pthread_barrier_t rendFim;
 static ThreadInfo* threads;
+static size_t n_threads_render = 0;
+
+//< Sinaliza às threads de renderização que devem encerrar. Não tem prazo: o
+// encerramento é sempre decidido pela thread principal (`finalizar_threads`),
+// senão as threads poderiam parar no meio de um quadro que ela ainda aguarda.
+static TokenParada paradaRender;
+
+//< Mantido pela thread principal enquanto cria as threads de renderização.
+static pthread_mutex_t portaoRender = PTHREAD_MUTEX_INITIALIZER;
+
+//< Indica que alguma thread de renderização não pôde ser criada (protegido por `portaoRender`).
+static bool criacaoFalhou = false;
 
 //< A função principal de cada thread.
 void *render_thread_main(void *_info) {
     ThreadInfo *info = _info;
 
-    // Contínuamente renderiza o mesmo retângulo
+    // Aguardar a criação das demais threads; caso alguma falhe, as barreiras
+    // nunca seriam liberadas, então encerrar sem renderizar
+    pthread_mutex_lock(&portaoRender);
+    bool falhou = criacaoFalhou;
+    pthread_mutex_unlock(&portaoRender);
+
+    if (falhou)
+        return NULL;
+
+    // Contínuamente renderiza o mesmo retângulo, até `finalizar_threads`
     while (true) {
         pthread_barrier_wait(&rendInicio);
+
+        // No encerramento a barreira é liberada sem um quadro para renderizar.
+        // Esta é a única saída do laço, para que toda thread chegue a `rendInicio`.
+        if (token_parado(&paradaRender))
+            break;
+
+        uint64_t inicio = agora_ns();
         renderizar(&info->rect);
+        info->tempo_render = agora_ns() - inicio;
         pthread_barrier_wait(&rendFim);
     }
 
@@ -248,25 +428,35 @@ void *render_thread_main(void *_info) {
 
 //< Inicializa todas as threads do programa.
 int inicializar_threads(size_t n_threads) {
-    threads = calloc(n_threads, sizeof(ThreadInfo));
-    if (threads == NULL) {
+    if (posix_memalign((void **)&threads, TAMANHO_LINHA_CACHE, n_threads * sizeof(ThreadInfo)) != 0) {
         SDL_Log("Não foi possível alocar memória para os dados das threads.");
         return 0;
     }
+    memset(threads, 0, n_threads * sizeof(ThreadInfo));
+    token_iniciar(&paradaRender, NULL, 0);
     
-    if (pthread_barrier_init(&rendInicio, NULL, n_threads + 1) != 0) {
-        SDL_Log("Não foi possível inicializar as barreiras: %s", strerror(errno));
+    int rc = pthread_barrier_init(&rendInicio, NULL, n_threads + 1);
+    if (rc != 0) {
+        SDL_Log("Não foi possível inicializar as barreiras: %s", strerror(rc));
+        free(threads);
         return 0;
     };
 
-    if (pthread_barrier_init(&rendFim, NULL, n_threads + 1) != 0) {
-        SDL_Log("Não foi possível inicializar as barreiras: %s", strerror(errno));
+    rc = pthread_barrier_init(&rendFim, NULL, n_threads + 1);
+    if (rc != 0) {
+        SDL_Log("Não foi possível inicializar as barreiras: %s", strerror(rc));
+        pthread_barrier_destroy(&rendInicio);
+        free(threads);
         return 0;
     };
     
     int tamanho_segmento = tamanhoTela / n_threads;
     int resto = tamanhoTela % n_threads;
     int inicio_segmento = 0;
+    size_t criadas = 0;
+
+    // As threads só começam após todas terem sido criadas
+    pthread_mutex_lock(&portaoRender);
 
     for (int i = 0; i < n_threads; i++) {
         ThreadInfo *t = threads + i;
@@ -281,15 +471,52 @@ int inicializar_threads(size_t n_threads) {
         inicio_segmento += t->rect.h;
 
         // Criar as threads
-        if (pthread_create(&t->thread, NULL, render_thread_main, t) != 0) {
-            SDL_Log("Não foi possível inicializar as threads: %s", strerror(errno));
-            return 0;
+        rc = pthread_create(&t->thread, NULL, render_thread_main, t);
+        if (rc != 0) {
+            SDL_Log("Não foi possível inicializar as threads: %s", strerror(rc));
+            break;
         }
+        criadas++;
     }
 
+    // Se alguma thread não foi criada, encerrar as já criadas antes que cheguem às barreiras
+    criacaoFalhou = criadas < n_threads;
+    pthread_mutex_unlock(&portaoRender);
+
+    if (criadas < n_threads) {
+        for (size_t i = 0; i < criadas; i++)
+            pthread_join(threads[i].thread, NULL);
+
+        pthread_barrier_destroy(&rendInicio);
+        pthread_barrier_destroy(&rendFim);
+        free(threads);
+        threads = NULL;
+        return 0;
+    }
+
+    n_threads_render = n_threads;
     return 1;
 }
 
+//< Encerra e aguarda as threads de renderização, liberando os seus recursos.
+void finalizar_threads(void) {
+    if (n_threads_render == 0)
+        return;
+
+    // As threads aguardam o próximo quadro em `rendInicio`
+    token_cancelar(&paradaRender);
+    pthread_barrier_wait(&rendInicio);
+
+    for (size_t i = 0; i < n_threads_render; i++)
+        pthread_join(threads[i].thread, NULL);
+
+    pthread_barrier_destroy(&rendInicio);
+    pthread_barrier_destroy(&rendFim);
+    free(threads);
+    threads = NULL;
+    n_threads_render = 0;
+}
+
 //< Renderizador sequencial - renderiza cada frame sequencialmente
 void renderizador_seq(void) {
     renderizar(NULL);
@@ -304,30 +531,51 @@ void renderizador_par(void) {
 //< Usado para se referir genericamente à `renderizador_seq` ou `renderizador_par`
 typedef void(*renderizador_f)(void);
 
+//< Indica se o modo/threads foram escolhidos pelo modelo de custo, para a saída.
+static bool decisaoAutomatica = false;
+
+//< O início da linha de saída (modo, tamanho e threads), impresso apenas se
+// a medição terminar, para que execuções interrompidas não deixem linhas parciais.
+static char prefixoSaida[64];
+
+//< Renderiza algumas linhas da tela para calibrar o modelo de custo.
+static void carga_renderizacao(void *dados) {
+    renderizar((const SDL_Rect *)dados);
+}
+
 //< Executa do início do programa,
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     renderizador_f* renderizador = (renderizador_f*)appstate;
     Args args = validar_argumentos(argc, argv);
     SDL_srand(args.seed);
 
+    // A simulação só é paralelizada com threads
+    if (args.mode == PROC) {
+        SDL_Log("O modo 'proc' não é suportado pela simulação.");
+        return SDL_APP_FAILURE;
+    }
+
+    // O ajuste de blocos só existe no produto de matrizes
+    if (args.ajustar || args.perfil) {
+        SDL_Log("As opções '--tune' e '--profile' só são suportadas pelo produto de matrizes.");
+        return SDL_APP_FAILURE;
+    }
+
     // Determinar o tamanho da tela pela linha de comando
     tamanhoTela = args.size;
     
-    // Calcular dinamicamente a quantidade de bolinhas a partir das dimensões.
-    size_t qtdCirculos = SDL_sqrt(tamanhoTela);
+    // Calcular dinamicamente a quantidade de bolinhas a partir das dimensões, se não for dada.
+    size_t qtdCirculos = args.circulos > 0 ? args.circulos : SDL_sqrt(tamanhoTela);
     if (!inicializar_circulos(qtdCirculos))
         return SDL_APP_FAILURE;
 
-    // Inicializar estado do renderizador
-    if (args.mode == PAR) {
-        *renderizador = renderizador_par;
-
-        if (!inicializar_threads(args.threads))
+    // Escolher a fase ampla da detecção de colisões
+    if (args.fase_ampla == AMPLA_VARREDURA) {
+        if (!inicializar_varredura())
             return SDL_APP_FAILURE;
-    } else {
-        *renderizador = renderizador_seq;
+        movimento = tentar_movimento_varredura;
     }
-    
+
     // Inicializar SDL
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_Log("Não foi possível inicializar o SDL: %s", SDL_GetError());
@@ -340,9 +588,61 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         return SDL_APP_FAILURE;
     }
 
-    // Imprimir parte da saída final do programa
-    printf("%s,%zu,%d,", args.mode == SEQ ? "seq" : "par", args.size, args.threads);
     canvas = SDL_CreateSurface(tamanhoTela, tamanhoTela, SDL_PIXELFORMAT_RGBA8888);
+
+    // Escolher modo e threads pelo modelo de custo, se pedido. Como as
+    // threads de renderização são persistentes, o custo por thread em cada
+    // quadro é o de acordá-las pelas barreiras.
+    if (precisa_modelo(&args)) {
+        SDL_Rect amostra = {
+            .x = 0,
+            .y = 0,
+            .w = tamanhoTela,
+            .h = tamanhoTela < LINHAS_AMOSTRA ? tamanhoTela : LINHAS_AMOSTRA,
+        };
+
+        double operacoes_amostra = (double)amostra.w * amostra.h * n_circulos;
+        ModeloCusto modelo = calibrar_modelo(carga_renderizacao, &amostra, operacoes_amostra);
+
+        double operacoes = (double)tamanhoTela * tamanhoTela * n_circulos;
+        resolver_execucao(&args, &modelo, operacoes, modelo.custo_despertar);
+    }
+    decisaoAutomatica = args.decisao_automatica;
+
+    // Inicializar estado do renderizador
+    if (args.mode == PAR) {
+        *renderizador = renderizador_par;
+
+        if (!inicializar_threads(args.threads))
+            return SDL_APP_FAILURE;
+    } else {
+        *renderizador = renderizador_seq;
+    }
+
+    // Guardar parte da saída final do programa
+    snprintf(prefixoSaida, sizeof(prefixoSaida), "%s,%zu,%d", nome_modo(&args), args.size, args.threads);
+
+    // Inicializar o gravador com tantos quadros quanto couberem no orçamento de memória
+    if (args.gravar) {
+        size_t bytes_quadro = (size_t)canvas->w * canvas->h * sizeof(Uint32);
+        size_t capacidade = ((size_t)MEMORIA_GRAVACAO << 20) / bytes_quadro;
+        if (capacidade > QUADROS_GRAVACAO) capacidade = QUADROS_GRAVACAO;
+
+        gravador = gravador_criar(args.gravar, canvas->w, canvas->h, FPS_GRAVACAO, capacidade, args.gravar_descartar);
+        if (!gravador)
+            return SDL_APP_FAILURE;
+    }
+
+    // Publicar os tempos de cada quadro para o `sim-monitor`
+    if (args.metricas) {
+        metricas = metricas_criar(args.metricas, n_threads_render > 0 ? n_threads_render : 1);
+        if (!metricas)
+            return SDL_APP_FAILURE;
+    }
+
+    // O prazo (`--deadline`) é consultado pela thread principal a cada quadro
+    definir_prazo_operacao(args.prazo);
+
     fpsPerf = SDL_GetPerformanceCounter();
     return SDL_APP_CONTINUE;
 }
@@ -352,22 +652,84 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
     return event->type == SDL_EVENT_QUIT ? SDL_APP_SUCCESS : SDL_APP_CONTINUE;
 }
 
+//< Converte um intervalo em ns para o registro de métricas, saturando em `UINT32_MAX`.
+static uint32_t intervalo_ns(uint64_t inicio, uint64_t fim) {
+    uint64_t ns = fim - inicio;
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+}
+
+//< Registra as fases de um quadro nas métricas compartilhadas.
+static void registrar_quadro(uint64_t inicio, uint64_t fisica, uint64_t render, uint64_t gravacao, uint64_t apresentar,
+    uint64_t fim) {
+    RegistroQuadro registro = { .quadro = frames };
+
+    registro.fases[FASE_FISICA] = intervalo_ns(inicio, fisica);
+    registro.fases[FASE_RENDER] = intervalo_ns(fisica, render);
+    registro.fases[FASE_GRAVACAO] = intervalo_ns(render, gravacao);
+    registro.fases[FASE_BLIT] = intervalo_ns(gravacao, apresentar);
+    registro.fases[FASE_APRESENTAR] = intervalo_ns(apresentar, fim);
+    registro.fases[FASE_QUADRO] = intervalo_ns(inicio, fim);
+
+    // No modo sequencial, a própria thread principal renderiza o quadro
+    if (n_threads_render == 0) {
+        registro.render[0] = registro.fases[FASE_RENDER];
+    } else {
+        // A espera de cada thread é o tempo da fase em que ela não renderizou
+        uint64_t espera = 0;
+        for (size_t i = 0; i < n_threads_render; i++) {
+            uint64_t tempo = threads[i].tempo_render;
+            if (i < MAX_THREADS_METRICAS)
+                registro.render[i] = tempo > UINT32_MAX ? UINT32_MAX : (uint32_t)tempo;
+            espera += tempo < render - fisica ? (render - fisica) - tempo : 0;
+        }
+        registro.fases[FASE_ESPERA] = intervalo_ns(0, espera / n_threads_render);
+    }
+
+    metricas_registrar(metricas, &registro);
+}
+
 //< Executa a cada tick do programa contínuamente.
 SDL_AppResult SDL_AppIterate(void *appstate) {
     renderizador_f renderizador = (renderizador_f)appstate;
     Uint64 perf = SDL_GetPerformanceCounter();
     Uint64 freq = (Uint64)TEMPO_EXECUCAO * SDL_GetPerformanceFrequency();
+
+    // Interromper a simulação caso o prazo passe antes do fim da medição
+    if (token_parado(token_operacao())) {
+        SDL_Log("Simulação interrompida após %.3fs", (double)(perf - fpsPerf) / SDL_GetPerformanceFrequency());
+        return SDL_APP_FAILURE;
+    }
     
+    uint64_t inicio = agora_ns();
+
     // Tratar colisões entre círculos círculos
     mover_circulos();
+    uint64_t fisica = agora_ns();
 
     // Desenhar quadro renderizado manualmente na janela
     renderizador();
+    uint64_t render = agora_ns();
+
+    // Guardar o hash do primeiro quadro para comparar os modos de execução
+    if (frames == 0) {
+        for (int y = 0; y < canvas->h; y++)
+            hashPrimeiroQuadro = hash_fnv1a(hashPrimeiroQuadro, (const Uint8 *)canvas->pixels + (size_t)y * canvas->pitch,
+                (size_t)canvas->w * sizeof(Uint32));
+    }
+
+    // Copiar o quadro finalizado para o anel de gravação
+    if (gravador)
+        gravador_enviar(gravador, canvas->pixels, canvas->pitch);
+    uint64_t gravacao = agora_ns();
 
     SDL_BlitSurface(canvas, 0, SDL_GetWindowSurface(window), 0);
+    uint64_t apresentar = agora_ns();
     
     // Enviar quadro novo para a tela
     SDL_UpdateWindowSurface(window);
+
+    if (metricas)
+        registrar_quadro(inicio, fisica, render, gravacao, apresentar, agora_ns());
     
     // Atualizar FPS
     frames++;
@@ -378,7 +740,7 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
         fps /= (double)(perf - fpsPerf) / (double)freq;
 
         // Imprimir FPS e finalizar a execução
-        printf("%.6f\n", fps);
+        printf("%s,%.6f,%016" PRIx64 ",%s\n", prefixoSaida, fps, hashPrimeiroQuadro, decisaoAutomatica ? "auto" : "manual");
         fflush(stdout);
         return SDL_APP_SUCCESS;
     }
@@ -389,5 +751,21 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
 //< Executa no fim da aplicação.
 void SDL_AppQuit(void *appstate, SDL_AppResult result)
 {
+    // Escrever os quadros pendentes e relatar perdas da gravação
+    if (gravador) {
+        EstatisticasGravacao e = gravador_finalizar(gravador);
+        SDL_Log("Gravação: %zu quadros enviados, %zu gravados, %zu descartados, %zu bloqueados%s",
+            e.enviados, e.gravados, e.descartados, e.bloqueados,
+            e.erro_escrita ? " (erro de escrita)" : "");
+        gravador = NULL;
+    }
+
+    // Sinalizar o fim da simulação aos monitores e remover as métricas
+    metricas_destruir(metricas);
+    metricas = NULL;
+
+    // Encerrar as threads de renderização antes que o SDL libere o canvas
+    finalizar_threads();
+
     /* SDL will clean up the window/renderer for us. */
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "utils.h"
 #include "log.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -12,9 +13,28 @@ double tempo_segundos() {
     return tv.tv_sec + tv.tv_usec / 1000000.0;
 }
 
+uint64_t hash_fnv1a(uint64_t hash, const void* dados, size_t n) {
+    const unsigned char* p = dados;
+    for (size_t i = 0; i < n; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+const char* nome_modo(const Args* args) {
+    switch (args->mode) {
+    case SEQ: return "seq";
+    case PAR: return "par";
+    case AUTO: return "auto";
+    case PROC: return "proc";
+    }
+    return "?";
+}
+
 //< Imprime uma mensagem padrão de uso do programa.
 void imprimir_uso(const char* prog_name) {
-    fprintf(stderr, "Uso: %s --size <N> --threads [T] --mode <seq|par> --seed [S]\n", prog_name);
+    fprintf(stderr, "Uso: %s --size <N> --threads [T|auto] --mode <seq|par|auto|proc> --seed [S] --record [arquivo] --record-drop --tune --profile [arquivo] --rhs [K] --transpose --metrics [nome] --broadphase <brute|sweep> --circles [N] --deadline [S]\n", prog_name);
 }
 
 Args validar_argumentos(int argc, char* argv[]) {
@@ -22,7 +42,18 @@ Args validar_argumentos(int argc, char* argv[]) {
         .size = 0,
         .threads = 1,
         .mode = SEQ,
+        .decisao_automatica = false,
         .seed = time(NULL),
+        .gravar = NULL,
+        .gravar_descartar = false,
+        .ajustar = false,
+        .perfil = NULL,
+        .rhs = 1,
+        .transposta = false,
+        .metricas = NULL,
+        .fase_ampla = AMPLA_BRUTA,
+        .circulos = 0,
+        .prazo = 0,
     };
     
     // Analisar argumentos da linha de comando 
@@ -31,8 +62,23 @@ Args validar_argumentos(int argc, char* argv[]) {
             args.size = atoll(argv[i+1]);
             i++;
         } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
-            args.threads = atoi(argv[i+1]);
-            i++;
+            const char* threads = argv[++i];
+
+            if (strcmp(threads, "auto") == 0) {
+                args.threads = THREADS_AUTO;
+            } else {
+                char* fim;
+                long valor = strtol(threads, &fim, 10);
+
+                // Rejeitar valores não numéricos, ao invés de tratá-los como 0
+                if (fim == threads || *fim != '\0') {
+                    imprimir_uso(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+
+                // Não permitir menos que 1 thread
+                args.threads = valor < 1 ? 1 : valor > INT_MAX ? INT_MAX : (int)valor;
+            }
         } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
             const char* mode = argv[++i];
             
@@ -41,6 +87,10 @@ Args validar_argumentos(int argc, char* argv[]) {
                 args.mode = SEQ;
             } else if (strcmp(mode, "par") == 0) {
                 args.mode = PAR;
+            } else if (strcmp(mode, "auto") == 0) {
+                args.mode = AUTO;
+            } else if (strcmp(mode, "proc") == 0) {
+                args.mode = PROC;
             } else {
                 fprintf(stderr, VERMELHO("ERRO") "\tModo inválido: %s\n", mode);
                 exit(EXIT_FAILURE);
@@ -48,17 +98,45 @@ Args validar_argumentos(int argc, char* argv[]) {
         } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
             args.seed = atoi(argv[i+1]);
             i++;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            args.gravar = argv[++i];
+        } else if (strcmp(argv[i], "--record-drop") == 0) {
+            args.gravar_descartar = true;
+        } else if (strcmp(argv[i], "--tune") == 0) {
+            args.ajustar = true;
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            args.perfil = argv[++i];
+        } else if (strcmp(argv[i], "--rhs") == 0 && i + 1 < argc) {
+            args.rhs = atoll(argv[++i]);
+            args.rhs = args.rhs < 1 ? 1 : args.rhs;
+        } else if (strcmp(argv[i], "--transpose") == 0) {
+            args.transposta = true;
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            args.metricas = argv[++i];
+        } else if (strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc) {
+            const char* fase = argv[++i];
+
+            if (strcmp(fase, "brute") == 0) {
+                args.fase_ampla = AMPLA_BRUTA;
+            } else if (strcmp(fase, "sweep") == 0) {
+                args.fase_ampla = AMPLA_VARREDURA;
+            } else {
+                fprintf(stderr, VERMELHO("ERRO") "\tFase ampla inválida: %s\n", fase);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--circles") == 0 && i + 1 < argc) {
+            args.circulos = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--deadline") == 0 && i + 1 < argc) {
+            args.prazo = atof(argv[++i]);
+            args.prazo = args.prazo > 0 ? args.prazo : 0;
         } else {
             imprimir_uso(argv[0]);
             exit(EXIT_FAILURE);
         }
     }
     
-    // Não permitir menos que 1 thread
-    args.threads = (args.threads < 1) ? 1 : args.threads;
-
-    // Verificar se o tamanho do vetor/matriz foi passado
-    if (args.size == 0) {
+    // Verificar se o tamanho do vetor/matriz foi passado (o ajuste usa tamanhos próprios)
+    if (args.size == 0 && !args.ajustar) {
         imprimir_uso(argv[0]);
         exit(EXIT_FAILURE);
     }
@@ -66,7 +144,7 @@ Args validar_argumentos(int argc, char* argv[]) {
 #ifndef NDEBUG
     // Imprimir valores para debugging
     fprintf(stderr, VERDE("DEBUG") "\tSize: %lu\n", args.size);
-    fprintf(stderr, VERDE("DEBUG") "\tMode: %s\n", args.mode == SEQ ? "seq" : "par");
+    fprintf(stderr, VERDE("DEBUG") "\tMode: %s\n", nome_modo(&args));
     fprintf(stderr, VERDE("DEBUG") "\tThreads: %d\n", args.threads);
 #endif
 